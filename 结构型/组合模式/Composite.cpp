@@ -1,39 +1,192 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <stdexcept>
+
+#include <cstring>
+#include <cerrno>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#if defined(SYS_getdents64) && defined(STATX_SIZE)
+#define COMPOSITE_HAVE_LINUX_SCAN 1
+#endif
+#endif
+
+class Directory;
 
 class FileSystemEntity {
+    friend class Directory;
+
+protected:
+    Directory* parent = nullptr;  // 一个节点只能属于一个目录
+
 public:
+    using Children = std::vector<std::shared_ptr<FileSystemEntity>>;
+
     virtual void display(int indent = 0) const = 0;
     virtual void add(std::shared_ptr<FileSystemEntity> entity) {
         // 默认不支持添加
     }
+    virtual void remove(const std::shared_ptr<FileSystemEntity>& /*entity*/) {
+        // 默认不支持删除
+    }
+    virtual const std::string& getName() const = 0;
+    virtual std::uint64_t getSize() const { return 0; }
+    virtual const Children* getChildren() const { return nullptr; }  // nullptr 表示叶子节点
+
+    // 子树聚合（包含自身）：叶子节点直接返回，目录返回缓存值
+    virtual std::uint64_t entryCount() const { return 1; }
+    virtual std::uint64_t totalSize() const { return getSize(); }
+    virtual std::uint32_t height() const { return 0; }
+
     virtual ~FileSystemEntity() = default;
 };
 
 class File : public FileSystemEntity {
 private:
     std::string name;
+    std::uint64_t size;
 
 public:
-    explicit File(const std::string& name) : name(name) {}
+    explicit File(const std::string& name, std::uint64_t size = 0) : name(name), size(size) {}
 
     void display(int indent = 0) const override {
         std::cout << std::string(indent, ' ') << "- File: " << name << "\n";
     }
+
+    const std::string& getName() const override { return name; }
+    std::uint64_t getSize() const override { return size; }
 };
 
+// 目录缓存子树的聚合值：
+// 条目数和总大小是可加的，add/remove 时把增量沿 parent 链加到根，O(depth)；
+// 高度不可减，remove 掉最高的子树后只把沿途目录标记为脏，下次查询时再按子节点缓存值修复。
+// 不变式：一个目录是脏的，则它的所有祖先也是脏的。
 class Directory : public FileSystemEntity {
 private:
     std::string name;
-    std::vector<std::shared_ptr<FileSystemEntity>> children;
+    Children children;
+
+    std::uint64_t cachedCount = 1;
+    std::uint64_t cachedSize = 0;
+    mutable std::uint32_t cachedHeight = 0;
+    mutable bool heightDirty = false;
+
+#ifdef COMPOSITE_HAVE_LINUX_SCAN
+    friend class DirectoryScanner;
+#endif
+
+    // 只挂接、不更新缓存：供并行扫描使用，避免多个线程同时沿 parent 链写祖先
+    void adopt(std::shared_ptr<FileSystemEntity> entity) {
+        entity->parent = this;
+        children.push_back(std::move(entity));
+    }
+
+    // 批量挂接完成后自底向上重算缓存
+    void recomputeAggregates() {
+        cachedCount = 1;
+        cachedSize = 0;
+        cachedHeight = 0;
+        heightDirty = false;
+        for (const auto& child : children) {
+            if (auto* dir = dynamic_cast<Directory*>(child.get())) {
+                dir->recomputeAggregates();
+            }
+            cachedCount += child->entryCount();
+            cachedSize += child->totalSize();
+            cachedHeight = std::max(cachedHeight, child->height() + 1);
+        }
+    }
+
+    void propagate(std::int64_t countDelta, std::int64_t sizeDelta) {
+        for (Directory* d = this; d; d = d->parent) {
+            d->cachedCount += countDelta;
+            d->cachedSize += sizeDelta;
+        }
+    }
 
 public:
     explicit Directory(const std::string& name) : name(name) {}
 
+    struct ScanStats {
+        std::uint64_t entries = 0;
+        std::uint64_t directories = 0;
+        std::uint64_t errors = 0;   // 无法打开或读取的目录、无法 stat 的条目
+        double seconds = 0.0;
+
+        double entriesPerSecond() const { return seconds > 0 ? entries / seconds : 0.0; }
+    };
+
+#ifndef COMPOSITE_HAVE_LINUX_SCAN
+    friend std::shared_ptr<Directory> scanPortable(const std::string& path, ScanStats* stats);
+#endif
+
+    // 扫描真实目录树，生成对应的组合结构（定义见 DirectoryScanner 之后）
+    static std::shared_ptr<Directory> scan(const std::string& path,
+                                           unsigned threads = std::thread::hardware_concurrency(),
+                                           ScanStats* stats = nullptr);
+
+    // 节点已挂在别的目录下时先从原目录摘下（原目录的缓存随之更新）；
+    // 不允许把自己或自己的祖先加进来，否则会形成环
     void add(std::shared_ptr<FileSystemEntity> entity) override {
-        children.push_back(entity);
+        for (const Directory* d = this; d; d = d->parent) {
+            if (d == entity.get()) {
+                throw std::invalid_argument("cannot add " + entity->getName() + " into its own subtree");
+            }
+        }
+        if (entity->parent) {
+            entity->parent->remove(entity);
+        }
+        entity->parent = this;
+        propagate(static_cast<std::int64_t>(entity->entryCount()),
+                  static_cast<std::int64_t>(entity->totalSize()));
+
+        // 高度只会变高：向上更新，直到某个祖先不再变化或已经是脏的
+        std::uint32_t h = entity->height() + 1;
+        for (Directory* d = this; d && !d->heightDirty && h > d->cachedHeight; d = d->parent, ++h) {
+            d->cachedHeight = h;
+        }
+
+        children.push_back(std::move(entity));
+    }
+
+    void remove(const std::shared_ptr<FileSystemEntity>& entity) override {
+        auto it = std::find(children.begin(), children.end(), entity);
+        if (it == children.end()) {
+            return;
+        }
+
+        propagate(-static_cast<std::int64_t>(entity->entryCount()),
+                  -static_cast<std::int64_t>(entity->totalSize()));
+
+        if (!heightDirty && entity->height() + 1 == cachedHeight) {
+            for (Directory* d = this; d && !d->heightDirty; d = d->parent) {
+                d->heightDirty = true;
+            }
+        }
+
+        entity->parent = nullptr;
+        children.erase(it);
     }
 
     void display(int indent = 0) const override {
@@ -42,9 +195,626 @@ public:
             child->display(indent + 4);  // 缩进
         }
     }
+
+    const std::string& getName() const override { return name; }
+    const Children* getChildren() const override { return &children; }
+
+    std::uint64_t entryCount() const override { return cachedCount; }
+    std::uint64_t totalSize() const override { return cachedSize; }
+
+    std::uint32_t height() const override {
+        if (heightDirty) {
+            // 只会递归进入脏的子目录，干净的子树直接用缓存
+            cachedHeight = 0;
+            for (const auto& child : children) {
+                cachedHeight = std::max(cachedHeight, child->height() + 1);
+            }
+            heightDirty = false;
+        }
+        return cachedHeight;
+    }
+};
+
+// ===== 扁平树：同一棵树的连续内存表示 =====
+// 节点按先序排列在一个数组里，用下标代替指针；名字统一存放在一块字符串 arena 中。
+// 先序排列保证任一节点的子树是连续区间 [i, subtreeEnd)，
+// 因此遍历只是顺序扫描，子树聚合也可以直接按区间切分给多个线程。
+class FlatTree {
+public:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    struct Entry {
+        std::uint32_t parent = kNone;
+        std::uint32_t firstChild = kNone;
+        std::uint32_t nextSibling = kNone;
+        std::uint32_t subtreeEnd = 0;   // 子树最后一个节点的下一个下标
+        std::uint32_t nameOffset = 0;
+        std::uint32_t nameLength = 0;
+        std::uint32_t depth = 0;
+        bool isDirectory = false;
+        std::uint64_t size = 0;
+    };
+
+    struct Aggregate {
+        std::uint64_t size = 0;
+        std::uint64_t count = 0;
+    };
+
+private:
+    std::vector<Entry> entries;
+    std::string names;
+
+public:
+    // 从指针树构建；用显式栈代替递归，深树也不会栈溢出
+    static FlatTree fromTree(const FileSystemEntity& root) {
+        FlatTree tree;
+        std::vector<std::uint32_t> lastChild;  // 每个已放置节点最近放置的子节点
+        struct Pending {
+            const FileSystemEntity* entity;
+            std::uint32_t parent;
+        };
+        std::vector<Pending> stack{{&root, kNone}};
+
+        while (!stack.empty()) {
+            Pending cur = stack.back();
+            stack.pop_back();
+
+            std::uint32_t index = static_cast<std::uint32_t>(tree.entries.size());
+            Entry e;
+            e.parent = cur.parent;
+            e.nameOffset = static_cast<std::uint32_t>(tree.names.size());
+            e.nameLength = static_cast<std::uint32_t>(cur.entity->getName().size());
+            e.size = cur.entity->getSize();
+            tree.names += cur.entity->getName();
+
+            if (cur.parent != kNone) {
+                Entry& parent = tree.entries[cur.parent];
+                e.depth = parent.depth + 1;
+                if (parent.firstChild == kNone) {
+                    parent.firstChild = index;
+                } else {
+                    tree.entries[lastChild[cur.parent]].nextSibling = index;
+                }
+                lastChild[cur.parent] = index;
+            }
+
+            const FileSystemEntity::Children* children = cur.entity->getChildren();
+            e.isDirectory = children != nullptr;
+            tree.entries.push_back(e);
+            lastChild.push_back(kNone);
+
+            if (children) {
+                // 逆序入栈，出栈顺序即原来的子节点顺序
+                for (auto it = children->rbegin(); it != children->rend(); ++it) {
+                    stack.push_back({it->get(), index});
+                }
+            }
+        }
+
+        // 先序数组中，节点的子树在其下一个兄弟（或某个祖先的下一个兄弟）之前结束；逆序扫描一次即可求出
+        for (std::size_t i = tree.entries.size(); i-- > 0;) {
+            Entry& e = tree.entries[i];
+            if (e.firstChild == kNone) {
+                e.subtreeEnd = static_cast<std::uint32_t>(i + 1);
+            } else {
+                std::uint32_t child = e.firstChild;
+                while (tree.entries[child].nextSibling != kNone) {
+                    child = tree.entries[child].nextSibling;
+                }
+                e.subtreeEnd = tree.entries[child].subtreeEnd;
+            }
+        }
+        return tree;
+    }
+
+    std::size_t size() const { return entries.size(); }
+    const Entry& operator[](std::uint32_t i) const { return entries[i]; }
+
+    std::string_view name(std::uint32_t i) const {
+        return std::string_view(names.data() + entries[i].nameOffset, entries[i].nameLength);
+    }
+
+    // 非递归遍历：先序数组本身就是显示顺序，深度已预先算好
+    void display(std::ostream& os = std::cout) const {
+        std::string spaces;
+        for (const Entry& e : entries) {
+            std::size_t indent = e.depth * 4;
+            if (spaces.size() < indent) {
+                spaces.resize(indent, ' ');
+            }
+            os.write(spaces.data(), static_cast<std::streamsize>(indent));
+            os << (e.isDirectory ? "+ Dir: " : "- File: ")
+               << std::string_view(names.data() + e.nameOffset, e.nameLength) << "\n";
+        }
+    }
+
+    // 子树聚合（总大小、节点数，包含 node 自身）；子树区间按线程数均分
+    Aggregate aggregate(std::uint32_t node, unsigned threads = 1) const {
+        std::uint32_t begin = node;
+        std::uint32_t end = entries[node].subtreeEnd;
+        threads = std::max(1u, std::min<unsigned>(threads, end - begin));
+
+        std::vector<Aggregate> partial(threads);
+        auto work = [&](unsigned t) {
+            std::size_t lo = begin + std::size_t(end - begin) * t / threads;
+            std::size_t hi = begin + std::size_t(end - begin) * (t + 1) / threads;
+            Aggregate a;
+            for (std::size_t i = lo; i < hi; ++i) {
+                a.size += entries[i].size;
+            }
+            a.count = hi - lo;
+            partial[t] = a;
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        Aggregate total;
+        for (const Aggregate& a : partial) {
+            total.size += a.size;
+            total.count += a.count;
+        }
+        return total;
+    }
+
+    std::size_t memoryBytes() const {
+        return entries.capacity() * sizeof(Entry) + names.capacity();
+    }
 };
 
-int main() {
+// ===== 真实文件系统扫描 =====
+#ifdef COMPOSITE_HAVE_LINUX_SCAN
+// Linux 实现：每个目录是一个任务：openat 相对父目录 fd 打开（不拼接完整路径），
+// getdents64 一次读出一批目录项，d_type 能区分类型时只对普通文件调用 statx 取大小。
+// 任务放在每个线程自己的双端队列里：自己从尾部取（深度优先，打开的 fd 数受深度限制），
+// 空闲线程从别人的头部偷（偷到的是较浅、通常更大的子树）。
+class DirectoryScanner {
+private:
+    // 父目录 fd 由所有待扫描的子目录任务共享，最后一个任务结束时关闭
+    struct DirFd {
+        int fd;
+        explicit DirFd(int fd) : fd(fd) {}
+        ~DirFd() { ::close(fd); }
+    };
+
+    struct Task {
+        std::shared_ptr<DirFd> parentFd;
+        std::string name;
+        Directory* dir;
+        bool root = false;   // 根路径允许是符号链接，子目录一律不跟随
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Worker> workers;
+    std::atomic<std::int64_t> pending{0};   // 已入队但尚未扫描完的任务
+    std::atomic<std::int64_t> queued{0};    // 还在队列里、没有被取走的任务
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    std::atomic<std::uint64_t> entries{0};
+    std::atomic<std::uint64_t> directories{0};
+    std::atomic<std::uint64_t> errors{0};
+    int rootErrno = 0;   // 根目录打不开时的 errno，join 之后由 scan() 读取
+
+    void push(unsigned self, Task task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(workers[self].mutex);
+            workers[self].tasks.push_back(std::move(task));
+            queued.fetch_add(1, std::memory_order_release);
+        }
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);   // 与 run() 中的等待配对，避免丢失唤醒
+        }
+        idle.notify_one();
+    }
+
+    bool pop(unsigned self, Task& out) {
+        {
+            std::lock_guard<std::mutex> lock(workers[self].mutex);
+            if (!workers[self].tasks.empty()) {
+                out = std::move(workers[self].tasks.back());
+                workers[self].tasks.pop_back();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (unsigned i = 1; i < workers.size(); ++i) {
+            Worker& victim = workers[(self + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                out = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void scanOne(unsigned self, Task& task, std::vector<char>& buffer) {
+        int fd = ::openat(task.parentFd->fd, task.name.c_str(),
+                          O_RDONLY | O_DIRECTORY | O_CLOEXEC | (task.root ? 0 : O_NOFOLLOW));
+        task.parentFd.reset();  // 尽早释放父目录 fd
+        if (fd < 0) {
+            if (task.root) {
+                rootErrno = errno;   // 例如根路径是普通文件时为 ENOTDIR
+            }
+            errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto self_fd = std::make_shared<DirFd>(fd);
+        std::uint64_t localEntries = 0;
+
+        for (;;) {
+            long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (n < 0) {
+                errors.fetch_add(1, std::memory_order_relaxed);   // 读目录失败：已读到的条目保留，但计为错误
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            for (long off = 0; off < n;) {
+                // struct linux_dirent64 { ino64_t d_ino; off64_t d_off; unsigned short d_reclen; unsigned char d_type; char d_name[]; }
+                const char* rec = buffer.data() + off;
+                unsigned short reclen;
+                std::memcpy(&reclen, rec + 16, sizeof(reclen));
+                unsigned char type = static_cast<unsigned char>(rec[18]);
+                const char* name = rec + 19;
+                off += reclen;
+
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                    continue;
+                }
+
+                struct statx stx;
+                bool needStat = type != DT_DIR;
+                if (needStat && ::statx(fd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                                        type == DT_UNKNOWN ? (STATX_TYPE | STATX_SIZE) : STATX_SIZE,
+                                        &stx) != 0) {
+                    errors.fetch_add(1, std::memory_order_relaxed);   // 例如条目在读目录和 stat 之间被删除
+                    continue;
+                }
+                if (type == DT_UNKNOWN && S_ISDIR(stx.stx_mode)) {
+                    type = DT_DIR;
+                }
+
+                ++localEntries;
+                if (type == DT_DIR) {
+                    auto child = std::make_shared<Directory>(name);
+                    Directory* raw = child.get();
+                    task.dir->adopt(std::move(child));
+                    push(self, Task{self_fd, name, raw});
+                } else {
+                    task.dir->adopt(std::make_shared<File>(name, stx.stx_size));
+                }
+            }
+        }
+
+        entries.fetch_add(localEntries, std::memory_order_relaxed);
+        directories.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run(unsigned self) {
+        std::vector<char> buffer(64 * 1024);
+        Task task;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (pop(self, task)) {
+                scanOne(self, task, buffer);
+                task = Task{};
+                // 子任务已先入队，计数不会提前归零；归零时唤醒所有等待的线程退出
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(idleMutex);
+                    idle.notify_all();
+                }
+            } else {
+                // 没有可偷的任务：阻塞等待新任务入队或全部完成，而不是空转
+                std::unique_lock<std::mutex> lock(idleMutex);
+                idle.wait(lock, [&] {
+                    return queued.load(std::memory_order_acquire) > 0 || pending.load(std::memory_order_acquire) == 0;
+                });
+            }
+        }
+    }
+
+public:
+    explicit DirectoryScanner(unsigned threads) : workers(std::max(1u, threads)) {}
+
+    std::shared_ptr<Directory> scan(const std::string& path, Directory::ScanStats* stats) {
+        auto start = std::chrono::steady_clock::now();
+
+        int cwd = ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (cwd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open .");
+        }
+        auto root = std::make_shared<Directory>(path);
+        push(0, Task{std::make_shared<DirFd>(cwd), path, root.get(), true});  // path 可以是绝对或相对路径
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < workers.size(); ++t) {
+            threads.emplace_back(&DirectoryScanner::run, this, t);
+        }
+        run(0);
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        if (directories.load() == 0) {
+            throw std::system_error(rootErrno ? rootErrno : ENOENT, std::generic_category(), "scan " + path);
+        }
+        root->recomputeAggregates();
+
+        if (stats) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            stats->entries = entries.load();
+            stats->directories = directories.load();
+            stats->errors = errors.load();
+            stats->seconds = elapsed.count();
+        }
+        return root;
+    }
+};
+
+std::shared_ptr<Directory> Directory::scan(const std::string& path, unsigned threads, ScanStats* stats) {
+    return DirectoryScanner(threads).scan(path, stats);
+}
+#else
+// 可移植实现：std::filesystem 单线程遍历，threads 参数被忽略
+std::shared_ptr<Directory> scanPortable(const std::string& path, Directory::ScanStats* stats) {
+    namespace fs = std::filesystem;
+    auto start = std::chrono::steady_clock::now();
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        throw std::system_error(ec ? ec : std::make_error_code(std::errc::not_a_directory), "scan " + path);
+    }
+
+    Directory::ScanStats local;
+    auto root = std::make_shared<Directory>(path);
+    std::vector<std::pair<fs::path, Directory*>> stack{{fs::path(path), root.get()}};
+    while (!stack.empty()) {
+        auto [dirPath, dir] = stack.back();
+        stack.pop_back();
+        fs::directory_iterator it(dirPath, ec);
+        if (ec) {
+            ++local.errors;
+            continue;
+        }
+        ++local.directories;
+        for (; it != fs::directory_iterator(); it.increment(ec)) {
+            fs::file_status status = it->symlink_status(ec);
+            if (ec) {
+                ++local.errors;
+                continue;
+            }
+            std::string name = it->path().filename().string();
+            ++local.entries;
+            if (fs::is_directory(status)) {
+                auto child = std::make_shared<Directory>(name);
+                stack.emplace_back(it->path(), child.get());
+                dir->adopt(std::move(child));
+            } else {
+                std::uintmax_t size = fs::is_regular_file(status) ? it->file_size(ec) : 0;
+                if (ec) {
+                    ++local.errors;
+                    size = 0;
+                }
+                dir->adopt(std::make_shared<File>(name, size));
+            }
+        }
+        if (ec) {
+            ++local.errors;
+        }
+    }
+    root->recomputeAggregates();
+
+    if (stats) {
+        *stats = local;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return root;
+}
+
+std::shared_ptr<Directory> Directory::scan(const std::string& path, unsigned, ScanStats* stats) {
+    return scanPortable(path, stats);
+}
+#endif
+
+// 指针树上的同一聚合：经典的递归 + 虚调用
+FlatTree::Aggregate aggregateRecursive(const FileSystemEntity& entity) {
+    FlatTree::Aggregate a{entity.getSize(), 1};
+    if (const auto* children = entity.getChildren()) {
+        for (const auto& child : *children) {
+            FlatTree::Aggregate c = aggregateRecursive(*child);
+            a.size += c.size;
+            a.count += c.count;
+        }
+    }
+    return a;
+}
+
+// 指针树的内存估算：make_shared 单块分配（控制块 + 对象）+ 超出 SSO 的名字 + 子节点 vector
+std::size_t pointerTreeBytes(const FileSystemEntity& entity) {
+    const std::size_t controlBlock = 2 * sizeof(int) + sizeof(void*);
+    const std::string& name = entity.getName();
+    std::size_t bytes = controlBlock + (name.capacity() > 15 ? name.capacity() + 1 : 0);
+    if (const auto* children = entity.getChildren()) {
+        bytes += sizeof(Directory) + children->capacity() * sizeof(std::shared_ptr<FileSystemEntity>);
+        for (const auto& child : *children) {
+            bytes += pointerTreeBytes(*child);
+        }
+    } else {
+        bytes += sizeof(File);
+    }
+    return bytes;
+}
+
+// ===== 基准测试用的合成树 =====
+// 每个目录下 8 个文件 + 2 个子目录，按层展开到 count 个节点；所有目录顺带记录到 dirs 中
+std::shared_ptr<Directory> buildSyntheticTree(std::size_t count,
+                                              std::vector<std::shared_ptr<Directory>>* dirs = nullptr) {
+    auto root = std::make_shared<Directory>("root");
+    std::vector<std::shared_ptr<Directory>> frontier{root};
+    std::size_t made = 1;
+    while (made < count && !frontier.empty()) {
+        std::vector<std::shared_ptr<Directory>> next;
+        for (const auto& dir : frontier) {
+            if (dirs) {
+                dirs->push_back(dir);
+            }
+            for (int f = 0; f < 8 && made < count; ++f, ++made) {
+                dir->add(std::make_shared<File>("file_" + std::to_string(made) + ".dat", made % 4096));
+            }
+            for (int d = 0; d < 2 && made < count; ++d, ++made) {
+                auto sub = std::make_shared<Directory>("dir_" + std::to_string(made));
+                dir->add(sub);
+                next.push_back(sub);
+            }
+        }
+        frontier.swap(next);
+    }
+    return root;
+}
+
+template <typename Fn>
+auto timed(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = fn();
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    return std::make_pair(result, ms.count());
+}
+
+// ===== 基准测试：指针树 vs 扁平树 =====
+// 默认 100 万个节点，千万级可用 ./Composite 20000000
+void benchmarkFlatTree(std::size_t count) {
+    auto root = buildSyntheticTree(count);
+
+    auto [flat, buildMs] = timed([&] { return FlatTree::fromTree(*root); });
+    auto [pointerAgg, pointerMs] = timed([&] { return aggregateRecursive(*root); });
+
+    std::cout << "entries = " << flat.size() << ", flat build = " << buildMs << " ms\n";
+    std::cout << "  pointer tree: " << pointerTreeBytes(*root) / (1024 * 1024) << " MB, traversal = "
+              << pointerMs << " ms, size = " << pointerAgg.size << "\n";
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        auto [flatAgg, flatMs] = timed([&] { return flat.aggregate(0, threads); });
+        std::cout << "  flat tree:    " << flat.memoryBytes() / (1024 * 1024) << " MB, traversal = "
+                  << flatMs << " ms, size = " << flatAgg.size << ", threads = " << threads << "\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+}
+
+// ===== 基准测试：增量缓存 vs 每次全量递归 =====
+// 操作序列按 queryPercent 混合“查询根目录总大小”和“随机目录增删一个文件”；
+// 全量递归每次查询都是 O(n)，所以只跑少量操作，报告单次操作平均耗时
+void benchmarkAggregateCache(std::size_t count) {
+    std::vector<std::shared_ptr<Directory>> dirs;
+    auto root = buildSyntheticTree(count, &dirs);
+
+    std::cout << "entries = " << root->entryCount() << ", height = " << root->height() << "\n";
+    for (int queryPercent : {90, 50, 10}) {
+        auto run = [&](std::size_t ops, bool cached) {
+            std::mt19937 rng(42);
+            std::vector<std::pair<Directory*, std::shared_ptr<FileSystemEntity>>> added;
+            std::uint64_t checksum = 0;
+            double ms = timed([&] {
+                for (std::size_t i = 0; i < ops; ++i) {
+                    if (static_cast<int>(rng() % 100) < queryPercent) {
+                        checksum += cached ? root->totalSize() : aggregateRecursive(*root).size;
+                    } else if (added.empty() || rng() % 2 == 0) {
+                        Directory* dir = dirs[rng() % dirs.size()].get();
+                        auto file = std::make_shared<File>("new.dat", rng() % 4096);
+                        dir->add(file);
+                        added.emplace_back(dir, file);
+                    } else {
+                        added.back().first->remove(added.back().second);
+                        added.pop_back();
+                    }
+                }
+                return checksum;
+            }).second;
+            for (auto& [dir, file] : added) {  // 恢复原树，供下一轮使用
+                dir->remove(file);
+            }
+            return ms * 1e3 / ops;
+        };
+
+        double cachedUs = run(1000000, true);
+        double fullUs = run(50, false);
+        std::cout << "  " << queryPercent << "% queries: cached = " << cachedUs
+                  << " us/op, full recompute = " << fullUs << " us/op\n";
+    }
+}
+
+// ===== 基准测试：扫描生成的目录树 =====
+// 在临时目录下生成 count 个条目（每个目录 8 个文件 + 2 个子目录），
+// 与 std::filesystem::recursive_directory_iterator 对比吞吐量；
+// 默认 2 万个条目，原始需求的 100 万可用第二个参数：./Composite 1000000 1000000
+void benchmarkScan(std::size_t count) {
+    namespace fs = std::filesystem;
+    // 每次新建一个原先不存在的目录（create_directory 返回 true 才算数），结束时只删除这个目录
+    fs::path base;
+    std::mt19937_64 rng{std::random_device{}()};
+    do {
+        base = fs::temp_directory_path() / ("composite_scan_bench_" + std::to_string(rng()));
+    } while (!fs::create_directory(base));
+
+    std::vector<fs::path> frontier{base};
+    std::size_t made = 0;
+    while (made < count && !frontier.empty()) {
+        std::vector<fs::path> next;
+        for (const auto& dir : frontier) {
+            for (int f = 0; f < 8 && made < count; ++f, ++made) {
+                std::ofstream(dir / ("file_" + std::to_string(made) + ".dat")) << std::string(made % 64, 'x');
+            }
+            for (int d = 0; d < 2 && made < count; ++d, ++made) {
+                fs::path sub = dir / ("dir_" + std::to_string(made));
+                fs::create_directory(sub);
+                next.push_back(sub);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    auto [iterated, iterMs] = timed([&] {
+        std::uint64_t n = 0;
+        for (auto it = fs::recursive_directory_iterator(base); it != fs::recursive_directory_iterator(); ++it) {
+            if (it->is_regular_file()) {
+                it->file_size();
+            }
+            ++n;
+        }
+        return n;
+    });
+    std::cout << "generated = " << made << ", std::filesystem: " << iterated * 1000.0 / iterMs << " entries/sec\n";
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        Directory::ScanStats stats;
+        auto root = Directory::scan(base.string(), threads, &stats);
+        std::cout << "  scan threads = " << threads << ": " << stats.entries << " entries, "
+                  << root->totalSize() << " bytes, " << stats.entriesPerSecond() << " entries/sec\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+
+    fs::remove_all(base);
+}
+
+int main(int argc, char* argv[]) {
     auto root = std::make_shared<Directory>("root");
     auto bin = std::make_shared<Directory>("bin");
     auto etc = std::make_shared<Directory>("etc");
@@ -65,6 +835,32 @@ int main() {
 
     root->display();
 
+    std::cout << "\n--- Flat Tree ---\n";
+    FlatTree flat = FlatTree::fromTree(*root);
+    flat.display();
+    std::uint32_t binIndex = flat[0].firstChild;
+    std::cout << flat.name(binIndex) << ": " << flat.aggregate(binIndex).count << " entries\n";
+
+    std::cout << "\n--- Cached Aggregates ---\n";
+    auto log = std::make_shared<File>("log.txt", 300);
+    user->add(log);
+    std::cout << "root: " << root->entryCount() << " entries, " << root->totalSize()
+              << " bytes, height " << root->height() << "\n";
+    user->remove(log);
+    home->remove(user);
+    std::cout << "root: " << root->entryCount() << " entries, " << root->totalSize()
+              << " bytes, height " << root->height() << "\n";
+
+    std::size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    std::cout << "\n--- Benchmark ---\n";
+    benchmarkFlatTree(count);
+
+    std::cout << "\n--- Aggregate Cache Benchmark ---\n";
+    benchmarkAggregateCache(count);
+
+    std::cout << "\n--- Filesystem Scan Benchmark ---\n";
+    benchmarkScan(argc > 2 ? std::stoull(argv[2]) : 20000);
+
     return 0;
 }
 
@@ -79,6 +875,39 @@ int main() {
     + Dir: home
         + Dir: user
             - File: readme.txt
+
+--- Flat Tree ---
++ Dir: root
+    + Dir: bin
+        - File: ls
+        - File: cat
+    + Dir: etc
+        - File: config.ini
+    + Dir: home
+        + Dir: user
+            - File: readme.txt
+bin: 3 entries
+
+--- Cached Aggregates ---
+root: 10 entries, 300 bytes, height 3
+root: 7 entries, 0 bytes, height 2
+
+--- Benchmark ---
+entries = 1000000, flat build = 118.9 ms
+  pointer tree: 100 MB, traversal = 15.3 ms, size = 1637188992
+  flat tree:    51 MB, traversal = 3.1 ms, size = 1637188992, threads = 1
+  ...（耗时因机器而异）
+
+--- Aggregate Cache Benchmark ---
+entries = 1000000, height = 17
+  90% queries: cached = 0.057 us/op, full recompute = 15374.2 us/op
+  50% queries: cached = 0.246 us/op, full recompute = 7195.3 us/op
+  10% queries: cached = 0.366 us/op, full recompute = 1760.3 us/op
+
+--- Filesystem Scan Benchmark ---
+generated = 20000, std::filesystem: 211862 entries/sec
+  scan threads = 1: 20000 entries, 503616 bytes, 454305 entries/sec
+  ...（吞吐量因磁盘和页缓存状态而异）
 */
 
 /*
@@ -91,4 +920,21 @@ int main() {
 /*
 一句话总结
 组合模式 = 把“单个对象”和“对象集合”抽象为统一类型，支持递归结构的统一操作。
-*/
\ No newline at end of file
+*/
+
+/*
+扁平树（FlatTree）：
+组合模式的指针树适合增删改，但节点分散在堆上、遍历要递归 + 虚调用。
+对只读的大树可以“快照”成先序数组：下标代替指针，名字集中存放，
+子树就是一段连续区间，遍历变成顺序扫描，聚合可以直接按区间并行。
+
+聚合缓存：
+目录缓存子树的条目数、总大小和高度，add/remove 时沿 parent 链增量更新（O(depth)），
+查询直接返回缓存（O(1)）；高度在删除后只打脏标记，下次查询时修复。
+
+目录扫描（Linux）：
+Directory::scan 用 openat + getdents64 + statx 读取真实目录树，不拼接完整路径，
+每个目录一个任务，由工作窃取线程池并行处理，最后自底向上一次性填好聚合缓存。
+这条路径只在 Linux 上启用；其他平台退回 std::filesystem 的单线程遍历。
+编译：g++ -std=c++17 -O2 -pthread Composite.cpp -o Composite
+*/
@@ -1,6 +1,27 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <utility>
+#include <type_traits>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <system_error>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define STREAM_HAS_SSE42_CRC 1
+#endif
 
 // 抽象组件：咖啡接口
 class Coffee {
@@ -58,8 +79,467 @@ public:
     }
 };
 
+// ===== 静态装饰：编译期组合 =====
+// 配料只描述自己（价格 + 名字），Decorated 继承自被装饰的具体咖啡，
+// cost() 里对 Base::cost() 的限定调用不是虚调用，整条链在编译期折叠成一个常量。
+// 组合结果仍然是 Coffee，可以和运行时装饰器混用。
+struct Milk {
+    static constexpr double price = 0.5;
+    static constexpr const char* name = "Milk";
+};
+
+struct Sugar {
+    static constexpr double price = 0.3;
+    static constexpr const char* name = "Sugar";
+};
+
+template <typename Base, typename... Toppings>
+class Decorated : public Base {
+private:
+    // 描述依赖 Base 的状态，按对象缓存：每个对象只拼接一次
+    mutable std::once_flag described;
+    mutable std::string description;
+
+public:
+    using Base::Base;
+
+    double cost() const override {
+        return Base::cost() + (0.0 + ... + Toppings::price);
+    }
+
+    std::string getDescription() const override {
+        std::call_once(described, [this] {
+            description = Base::getDescription();
+            ((description += ", ", description += Toppings::name), ...);
+        });
+        return description;
+    }
+};
+
+// ===== 运行时扁平化：把已经搭好的装饰链压成一个节点 =====
+// 价格在压缩时算好；描述第一次用到时才向原链要一次并缓存（原链保留，仅用于生成描述）
+class FlattenedCoffee : public Coffee {
+private:
+    std::shared_ptr<Coffee> chain;
+    double total;
+    mutable std::once_flag described;
+    mutable std::string description;
+
+public:
+    explicit FlattenedCoffee(std::shared_ptr<Coffee> c) : chain(std::move(c)), total(chain->cost()) {}
+
+    static std::shared_ptr<Coffee> flatten(std::shared_ptr<Coffee> c) {
+        return std::make_shared<FlattenedCoffee>(std::move(c));
+    }
+
+    std::string getDescription() const override {
+        std::call_once(described, [this] { description = chain->getDescription(); });
+        return description;
+    }
+
+    double cost() const override {
+        return total;
+    }
+};
+
+// ===== 基准测试：1~32 层装饰 =====
+// 三种表示都通过 Coffee 指针调用（入口保留一次虚调用），比较 cost() 和 getDescription() 的单次耗时
+template <std::size_t... I>
+auto makeStaticChain(std::index_sequence<I...>)
+    -> Decorated<SimpleCoffee, std::conditional_t<I % 2 == 0, Milk, Sugar>...>;
+
+template <std::size_t Depth>
+using StaticChain = decltype(makeStaticChain(std::make_index_sequence<Depth>{}));
+
+template <std::size_t Depth>
+void benchmarkDecoratorDepth(std::size_t calls) {
+    std::shared_ptr<Coffee> dynamic = std::make_shared<SimpleCoffee>();
+    for (std::size_t i = 0; i < Depth; ++i) {
+        if (i % 2 == 0) {
+            dynamic = std::make_shared<MilkDecorator>(dynamic);
+        } else {
+            dynamic = std::make_shared<SugarDecorator>(dynamic);
+        }
+    }
+    std::vector<std::pair<const char*, std::shared_ptr<Coffee>>> variants = {
+        {"dynamic", dynamic},
+        {"flattened", FlattenedCoffee::flatten(dynamic)},
+        {"static", std::make_shared<StaticChain<Depth>>()},
+    };
+
+    std::cout << "  depth " << Depth << ":";
+    for (auto& [name, coffee] : variants) {
+        auto start = std::chrono::steady_clock::now();
+        double sum = 0;
+        for (std::size_t i = 0; i < calls; ++i) {
+            sum += coffee->cost();
+        }
+        double costNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+
+        std::size_t descCalls = calls / 100;
+        start = std::chrono::steady_clock::now();
+        std::size_t length = 0;
+        for (std::size_t i = 0; i < descCalls; ++i) {
+            length += coffee->getDescription().size();
+        }
+        double descNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / descCalls;
+
+        std::cout << "  " << name << " cost = " << costNs << " ns, desc = " << descNs << " ns"
+                  << (sum < 0 || length == 0 ? "?" : "");
+    }
+    std::cout << "\n";
+}
+
+// ===== 同一模式用于字节流：可叠加的 I/O 管道 =====
+// 写方向的管道：调用方把自己持有的缓冲区按块写入，装饰器只在必要时才复制
+//（BufferedStream 合并小块、RleStream 产生新的压缩字节），其余装饰器直接把同一个指针往下传。
+class Stream {
+public:
+    virtual void write(const std::uint8_t* data, std::size_t size) = 0;
+    virtual void flush() {}
+    virtual ~Stream() {}
+};
+
+// 具体组件：写入文件描述符
+class FdStream : public Stream {
+private:
+    int fd;
+
+public:
+    explicit FdStream(int fd) : fd(fd) {}
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "write");
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+};
+
+// 抽象装饰器
+class StreamDecorator : public Stream {
+protected:
+    std::shared_ptr<Stream> inner;
+public:
+    StreamDecorator(std::shared_ptr<Stream> s) : inner(s) {}
+
+    void flush() override {
+        inner->flush();
+    }
+};
+
+// 具体装饰器：缓冲。小块先攒进缓冲区，够大的块在缓冲区为空时直接透传
+class BufferedStream : public StreamDecorator {
+private:
+    std::vector<std::uint8_t> buffer;
+    std::size_t used = 0;
+
+public:
+    BufferedStream(std::shared_ptr<Stream> s, std::size_t capacity = 64 * 1024)
+        : StreamDecorator(s), buffer(capacity) {}
+
+    ~BufferedStream() override {
+        try {
+            flushBuffer();
+        } catch (...) {
+        }
+    }
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        if (used == 0 && size >= buffer.size()) {
+            inner->write(data, size);
+            return;
+        }
+        while (size > 0) {
+            std::size_t n = std::min(size, buffer.size() - used);
+            std::memcpy(buffer.data() + used, data, n);
+            used += n;
+            data += n;
+            size -= n;
+            if (used == buffer.size()) {
+                flushBuffer();
+            }
+        }
+    }
+
+    void flush() override {
+        flushBuffer();
+        inner->flush();
+    }
+
+private:
+    void flushBuffer() {
+        if (used > 0) {
+            inner->write(buffer.data(), used);
+            used = 0;
+        }
+    }
+};
+
+// CRC32C（Castagnoli）：有 SSE4.2 时用 crc32 指令，否则用 slicing-by-8 查表
+class Crc32c {
+private:
+    static const std::array<std::array<std::uint32_t, 256>, 8>& table() {
+        static const auto t = [] {
+            std::array<std::array<std::uint32_t, 256>, 8> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+                }
+                t[0][i] = c;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (int k = 1; k < 8; ++k) {
+                    t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+                }
+            }
+            return t;
+        }();
+        return t;
+    }
+
+#ifdef STREAM_HAS_SSE42_CRC
+    __attribute__((target("sse4.2")))
+    static std::uint32_t updateHardware(std::uint32_t crc, const std::uint8_t* p, std::size_t n) {
+        std::uint64_t c = crc;
+        for (; n >= 8; p += 8, n -= 8) {
+            std::uint64_t v;
+            std::memcpy(&v, p, 8);
+            c = _mm_crc32_u64(c, v);
+        }
+        std::uint32_t c32 = static_cast<std::uint32_t>(c);
+        for (; n > 0; ++p, --n) {
+            c32 = _mm_crc32_u8(c32, *p);
+        }
+        return c32;
+    }
+#endif
+
+public:
+    static bool hardwareAvailable() {
+#ifdef STREAM_HAS_SSE42_CRC
+        static const bool available = __builtin_cpu_supports("sse4.2");
+        return available;
+#else
+        return false;
+#endif
+    }
+
+    static std::uint32_t updateTable(std::uint32_t crc, const std::uint8_t* p, std::size_t n) {
+        const auto& t = table();
+        for (; n >= 8; p += 8, n -= 8) {
+            std::uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + 4, 4);
+            lo ^= crc;   // 按小端读取
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+        for (; n > 0; ++p, --n) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+        }
+        return crc;
+    }
+
+    // crc 为未取反的中间状态，初值 0xFFFFFFFF，结束时取反
+    static std::uint32_t update(std::uint32_t crc, const std::uint8_t* p, std::size_t n) {
+#ifdef STREAM_HAS_SSE42_CRC
+        if (hardwareAvailable()) {
+            return updateHardware(crc, p, n);
+        }
+#endif
+        return updateTable(crc, p, n);
+    }
+};
+
+// 具体装饰器：校验和。只读经过的数据，原指针透传
+class Crc32cStream : public StreamDecorator {
+private:
+    std::uint32_t state = 0xFFFFFFFFu;
+
+public:
+    Crc32cStream(std::shared_ptr<Stream> s) : StreamDecorator(s) {}
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        state = Crc32c::update(state, data, size);
+        inner->write(data, size);
+    }
+
+    std::uint32_t value() const {
+        return ~state;
+    }
+};
+
+// 具体装饰器：计数
+class CountingStream : public StreamDecorator {
+private:
+    std::uint64_t bytes = 0;
+    std::uint64_t writes = 0;
+
+public:
+    CountingStream(std::shared_ptr<Stream> s) : StreamDecorator(s) {}
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        bytes += size;
+        ++writes;
+        inner->write(data, size);
+    }
+
+    std::uint64_t byteCount() const { return bytes; }
+    std::uint64_t writeCount() const { return writes; }
+};
+
+// 具体装饰器：PackBits 风格的游程编码
+// 头字节 h < 128：后面跟 h+1 个原样字节；h >= 128：下一个字节重复 h-125 次（3~130 次）。
+// 每个写入块独立编码，编码结果写进复用的内部缓冲区后交给下一层
+class RleStream : public StreamDecorator {
+private:
+    std::vector<std::uint8_t> out;
+
+public:
+    RleStream(std::shared_ptr<Stream> s) : StreamDecorator(s) {}
+
+    static void encode(const std::uint8_t* p, std::size_t n, std::vector<std::uint8_t>& out) {
+        out.clear();
+        out.reserve(n + n / 128 + 1);
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t run = 1;
+            while (i + run < n && run < 130 && p[i + run] == p[i]) {
+                ++run;
+            }
+            if (run >= 3) {
+                out.push_back(static_cast<std::uint8_t>(run + 125));
+                out.push_back(p[i]);
+                i += run;
+                continue;
+            }
+            // 收集原样字节，直到遇到长度 >= 3 的游程
+            std::size_t start = i;
+            while (i < n && i - start < 128) {
+                if (i + 2 < n && p[i] == p[i + 1] && p[i] == p[i + 2]) {
+                    break;
+                }
+                ++i;
+            }
+            out.push_back(static_cast<std::uint8_t>(i - start - 1));
+            out.insert(out.end(), p + start, p + i);
+        }
+    }
+
+    // 截断或不合法的输入（头字节后面的数据不够）抛 std::runtime_error，不会越界读
+    static std::vector<std::uint8_t> decode(const std::uint8_t* p, std::size_t n) {
+        std::vector<std::uint8_t> out;
+        for (std::size_t i = 0; i < n;) {
+            std::uint8_t h = p[i++];
+            std::size_t need = h < 128 ? h + 1u : 1u;
+            if (n - i < need) {
+                throw std::runtime_error("RLE: truncated input at offset " + std::to_string(i - 1));
+            }
+            if (h < 128) {
+                out.insert(out.end(), p + i, p + i + need);
+                i += need;
+            } else {
+                out.insert(out.end(), static_cast<std::size_t>(h - 125), p[i++]);
+            }
+        }
+        return out;
+    }
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        encode(data, size, out);
+        inner->write(out.data(), out.size());
+    }
+};
+
+// 测试用的内存终端
+class MemoryStream : public Stream {
+public:
+    std::vector<std::uint8_t> bytes;
+
+    void write(const std::uint8_t* data, std::size_t size) override {
+        bytes.insert(bytes.end(), data, data + size);
+    }
+};
+
+// ===== 基准测试：从本地文件流式读取，经不同管道写到 /dev/null =====
+// 默认 256MB；原始需求的 10GB 用 ./Decorator 10240（单位 MB）
+void benchmarkStreamPipeline(std::size_t megabytes) {
+    namespace fs = std::filesystem;
+    fs::path path = fs::temp_directory_path() / "decorator_stream_bench.bin";
+    {
+        // 半可压缩的数据：交替出现长游程和噪声
+        std::ofstream out(path, std::ios::binary);
+        std::vector<char> chunk(1 << 20);
+        std::uint32_t x = 12345;
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            x = x * 1103515245 + 12345;
+            chunk[i] = (i / 256) % 2 ? static_cast<char>(i / 4096) : static_cast<char>(x >> 24);
+        }
+        for (std::size_t m = 0; m < megabytes; ++m) {
+            out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }
+    }
+
+    int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (devNull < 0) {
+        throw std::system_error(errno, std::generic_category(), "open /dev/null");
+    }
+    std::vector<std::uint8_t> buffer(1 << 20);   // 调用方持有的读缓冲区
+
+    auto run = [&](const char* name, std::shared_ptr<Stream> pipeline) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t total = 0;
+        for (ssize_t n; (n = ::read(fd, buffer.data(), buffer.size())) > 0;) {
+            pipeline->write(buffer.data(), static_cast<std::size_t>(n));
+            total += static_cast<std::uint64_t>(n);
+        }
+        pipeline->flush();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ::close(fd);
+        std::cout << "  " << name << ": " << total / sec / (1 << 20) << " MB/s\n";
+    };
+
+    auto sink = std::make_shared<FdStream>(devNull);
+    run("fd", sink);
+    run("counting > crc32c > fd", std::make_shared<CountingStream>(std::make_shared<Crc32cStream>(sink)));
+
+    auto counted = std::make_shared<CountingStream>(sink);
+    run("crc32c > rle > buffered > counting > fd",
+        std::make_shared<Crc32cStream>(std::make_shared<RleStream>(std::make_shared<BufferedStream>(counted))));
+    std::cout << "  rle ratio = " << static_cast<double>(counted->byteCount()) / (megabytes << 20) << "\n";
+
+    // 单独比较 CRC 的两种实现
+    for (bool hardware : {false, true}) {
+        if (hardware && !Crc32c::hardwareAvailable()) {
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for (int r = 0; r < 256; ++r) {
+            crc = hardware ? Crc32c::update(crc, buffer.data(), buffer.size())
+                           : Crc32c::updateTable(crc, buffer.data(), buffer.size());
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  crc32c " << (hardware ? "sse4.2" : "table ") << ": " << 256 / sec << " MB/s"
+                  << (crc == 0 ? "?" : "") << "\n";
+    }
+
+    ::close(devNull);
+    fs::remove(path);
+}
+
 // 主函数测试
-int main() {
+int main(int argc, char* argv[]) {
     // 原味咖啡
     std::shared_ptr<Coffee> myCoffee = std::make_shared<SimpleCoffee>();
     std::cout << myCoffee->getDescription() << " : $" << myCoffee->cost() << "\n";
@@ -72,6 +552,43 @@ int main() {
     myCoffee = std::make_shared<SugarDecorator>(myCoffee);
     std::cout << myCoffee->getDescription() << " : $" << myCoffee->cost() << "\n";
 
+    // 扁平化：价格预先算好，描述第一次用到时才生成
+    std::shared_ptr<Coffee> flat = FlattenedCoffee::flatten(myCoffee);
+    std::cout << flat->getDescription() << " : $" << flat->cost() << " (flattened)\n";
+
+    // 静态组合：编译期确定的装饰链
+    Decorated<SimpleCoffee, Milk, Sugar> fused;
+    std::cout << fused.getDescription() << " : $" << fused.cost() << " (static)\n";
+
+    // 字节流装饰器：计数 > 校验 > 压缩 > 缓冲 > 内存
+    std::cout << "\n--- Stream Decorators ---\n";
+    auto memory = std::make_shared<MemoryStream>();
+    auto crc = std::make_shared<Crc32cStream>(std::make_shared<RleStream>(std::make_shared<BufferedStream>(memory)));
+    auto counter = std::make_shared<CountingStream>(crc);
+    const std::string text = "123456789";
+    counter->write(reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+    const std::string runs(100, 'a');
+    counter->write(reinterpret_cast<const std::uint8_t*>(runs.data()), runs.size());
+    counter->flush();
+    std::vector<std::uint8_t> decoded = RleStream::decode(memory->bytes.data(), memory->bytes.size());
+    std::cout << "Wrote " << counter->byteCount() << " bytes, compressed to " << memory->bytes.size()
+              << ", round trip " << (std::string(decoded.begin(), decoded.end()) == text + runs ? "ok" : "failed") << "\n";
+    std::cout << std::hex << "crc32c(\"123456789\") = 0x"
+              << (~Crc32c::update(0xFFFFFFFFu, reinterpret_cast<const std::uint8_t*>(text.data()), text.size()))
+              << ", crc32c(all) = 0x" << crc->value() << std::dec << "\n";
+
+    std::cout << "\n--- Benchmark ---\n";
+    const std::size_t calls = 10000000;
+    benchmarkDecoratorDepth<1>(calls);
+    benchmarkDecoratorDepth<2>(calls);
+    benchmarkDecoratorDepth<4>(calls);
+    benchmarkDecoratorDepth<8>(calls);
+    benchmarkDecoratorDepth<16>(calls);
+    benchmarkDecoratorDepth<32>(calls);
+
+    std::cout << "\n--- Stream Benchmark ---\n";
+    benchmarkStreamPipeline(argc > 1 ? std::stoull(argv[1]) : 256);
+
     return 0;
 }
 
@@ -79,4 +596,29 @@ int main() {
 // Simple Coffee : $2
 // Simple Coffee, Milk : $2.5
 // Simple Coffee, Milk, Sugar : $2.8
+// Simple Coffee, Milk, Sugar : $2.8 (flattened)
+// Simple Coffee, Milk, Sugar : $2.8 (static)
+//
+// --- Stream Decorators ---
+// Wrote 109 bytes, compressed to 12, round trip ok
+// crc32c("123456789") = 0xe3069283, crc32c(all) = 0x13bd1de4
+//
+// --- Benchmark ---（耗时因机器而异）
+//   depth 1:  dynamic cost = 2.7 ns, desc = 29.4 ns  flattened cost = 2.7 ns, desc = 23.8 ns  static cost = 2.7 ns, desc = 21.6 ns
+//   depth 8:  dynamic cost = 12.5 ns, desc = 137.9 ns  flattened cost = 2.7 ns, desc = 21.8 ns  static cost = 2.7 ns, desc = 20.5 ns
+//   depth 32:  dynamic cost = 60.3 ns, desc = 522.7 ns  flattened cost = 2.6 ns, desc = 25.3 ns  static cost = 2.7 ns, desc = 22.4 ns
+//
+//
+// --- Stream Benchmark ---
+//   fd: 6835.1 MB/s
+//   counting > crc32c > fd: 3463.9 MB/s
+//   crc32c > rle > buffered > counting > fd: 828.7 MB/s
+//   rle ratio = 0.511703
+//   crc32c table : 1788.6 MB/s
+//   crc32c sse4.2: 7012.8 MB/s
+//
+// 装饰链很深时：组合在编译期已知就用 Decorated<...> 静态组合；
+// 运行时才搭出来的链，搭好后用 FlattenedCoffee::flatten 压成一个节点再反复使用。
+// 字节流装饰器（Stream）按块传递调用方的缓冲区指针，只有缓冲和压缩这两层需要产生新字节。
+// 编译：g++ -std=c++17 -O2 Decorator.cpp -o Decorator
 
@@ -1,6 +1,12 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <array>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <variant>
 
 // 前向声明
 class Circle;
@@ -71,8 +77,282 @@ public:
     }
 };
 
+// ===== 可归约访问者：返回结果而不是打印 =====
+// 并行遍历时每个线程持有一份 clone() 出来的访问者，各自累加，最后通过 merge() 归约
+template <typename R>
+class ReduceVisitor : public Visitor {
+public:
+    using result_type = R;
+
+    virtual std::unique_ptr<ReduceVisitor> clone() const = 0;
+    virtual void merge(const ReduceVisitor& other) = 0;  // other 必须是同一具体类型
+    virtual R result() const = 0;
+};
+
+// 具体可归约访问者：总面积
+class TotalAreaVisitor : public ReduceVisitor<double> {
+private:
+    double total = 0.0;
+
+public:
+    void visit(Circle* c) override {
+        total += 3.14159 * c->radius * c->radius;
+    }
+
+    void visit(Rectangle* r) override {
+        total += static_cast<double>(r->width) * r->height;
+    }
+
+    std::unique_ptr<ReduceVisitor<double>> clone() const override {
+        return std::make_unique<TotalAreaVisitor>();  // 每个线程从 0 开始累加
+    }
+
+    void merge(const ReduceVisitor<double>& other) override {
+        total += static_cast<const TotalAreaVisitor&>(other).total;
+    }
+
+    double result() const override {
+        return total;
+    }
+};
+
+// 具体可归约访问者：按面积分桶的直方图，[0,1) [1,2) ... 最后一桶收集其余所有
+class AreaHistogramVisitor : public ReduceVisitor<std::array<std::size_t, 8>> {
+public:
+    static constexpr std::size_t kBuckets = 8;
+    using Histogram = std::array<std::size_t, kBuckets>;
+
+private:
+    float bucketWidth;
+    Histogram buckets{};
+
+    void record(float area) {
+        std::size_t i = static_cast<std::size_t>(area / bucketWidth);
+        ++buckets[std::min(i, kBuckets - 1)];
+    }
+
+public:
+    explicit AreaHistogramVisitor(float width) : bucketWidth(width) {}
+
+    void visit(Circle* c) override {
+        record(3.14159f * c->radius * c->radius);
+    }
+
+    void visit(Rectangle* r) override {
+        record(r->width * r->height);
+    }
+
+    std::unique_ptr<ReduceVisitor<Histogram>> clone() const override {
+        return std::make_unique<AreaHistogramVisitor>(bucketWidth);
+    }
+
+    void merge(const ReduceVisitor<Histogram>& other) override {
+        const auto& o = static_cast<const AreaHistogramVisitor&>(other);
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            buckets[i] += o.buckets[i];
+        }
+    }
+
+    Histogram result() const override {
+        return buckets;
+    }
+};
+
+// ===== 并行遍历 =====
+// 把 shapes 切成 threads 段连续区间，每段由一个线程用自己的访问者副本遍历，
+// 线程之间没有共享写，最后在调用线程里按顺序 merge，结果与串行遍历一致（浮点求和顺序除外）
+template <typename R>
+R parallelAccept(const std::vector<std::shared_ptr<Shape>>& shapes,
+                 const ReduceVisitor<R>& visitor, unsigned threads) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(shapes.size())));
+
+    std::vector<std::unique_ptr<ReduceVisitor<R>>> locals;
+    for (unsigned t = 0; t < threads; ++t) {
+        locals.push_back(visitor.clone());
+    }
+
+    auto work = [&](unsigned t) {
+        std::size_t begin = shapes.size() * t / threads;
+        std::size_t end = shapes.size() * (t + 1) / threads;
+        ReduceVisitor<R>* v = locals[t].get();
+        for (std::size_t i = begin; i < end; ++i) {
+            shapes[i]->accept(v);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(work, t);
+    }
+    work(0);  // 调用线程自己也干活
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (unsigned t = 1; t < threads; ++t) {
+        locals[0]->merge(*locals[t]);
+    }
+    return locals[0]->result();
+}
+
+// ===== 扩展性测试：1..N 线程 =====
+// 默认 100 万个图形；原始需求的 1 亿个（约 5GB 内存）可用 ./Visitor 100000000
+void benchmarkParallelAccept(std::size_t count) {
+    std::vector<std::shared_ptr<Shape>> shapes;
+    shapes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        float x = static_cast<float>(i % 100) / 50.0f;
+        if (i % 2 == 0) {
+            shapes.push_back(std::make_shared<Circle>(x));
+        } else {
+            shapes.push_back(std::make_shared<Rectangle>(x, 1.5f));
+        }
+    }
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    TotalAreaVisitor totalArea;
+    double baseline = 0.0;
+
+    std::cout << "shapes = " << count << ", cores = " << maxThreads << "\n";
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        auto start = std::chrono::steady_clock::now();
+        double area = parallelAccept(shapes, totalArea, threads);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+        if (threads == 1) {
+            baseline = ms.count();
+        }
+        std::cout << "  threads = " << threads
+                  << ", total area = " << area
+                  << ", time = " << ms.count() << " ms"
+                  << ", speedup = " << baseline / ms.count() << "x\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+}
+
+// ===== 封闭层次的替代实现：std::variant + std::visit =====
+// 元素类型集合固定时，不再需要 accept()/visit() 两次虚调用和 shared_ptr 堆节点：
+// 图形按值存放在连续的 vector 里，访问者是一组重载的 lambda
+namespace closed {
+
+struct Circle {
+    float radius;
+};
+
+struct Rectangle {
+    float width;
+    float height;
+};
+
+using ShapeV = std::variant<Circle, Rectangle>;
+
+// 把若干 lambda 合并成一个重载集合
+template <typename... Fs>
+struct overloaded : Fs... {
+    using Fs::operator()...;
+};
+template <typename... Fs>
+overloaded(Fs...) -> overloaded<Fs...>;
+
+inline float area(const ShapeV& shape) {
+    return std::visit(overloaded{
+        [](const Circle& c) { return 3.14159f * c.radius * c.radius; },
+        [](const Rectangle& r) { return r.width * r.height; },
+    }, shape);
+}
+
+// 从原有继承体系转换：借助一个经典访问者识别具体类型
+class ToVariantVisitor : public Visitor {
+public:
+    ShapeV out = Circle{0.0f};
+
+    void visit(::Circle* c) override {
+        out = Circle{c->radius};
+    }
+
+    void visit(::Rectangle* r) override {
+        out = Rectangle{r->width, r->height};
+    }
+};
+
+inline ShapeV toVariant(Shape& shape) {
+    ToVariantVisitor v;
+    shape.accept(&v);
+    return v.out;
+}
+
+inline std::vector<ShapeV> toVariants(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    std::vector<ShapeV> out;
+    out.reserve(shapes.size());
+    for (const auto& shape : shapes) {
+        out.push_back(toVariant(*shape));
+    }
+    return out;
+}
+
+// 反向转换：回到原有的继承体系
+inline std::shared_ptr<Shape> toShape(const ShapeV& shape) {
+    return std::visit(overloaded{
+        [](const Circle& c) -> std::shared_ptr<Shape> { return std::make_shared<::Circle>(c.radius); },
+        [](const Rectangle& r) -> std::shared_ptr<Shape> { return std::make_shared<::Rectangle>(r.width, r.height); },
+    }, shape);
+}
+
+}  // namespace closed
+
+// ===== 两种表示的遍历耗时与单个图形内存占用对比 =====
+void benchmarkVariantVsVirtual(std::size_t count) {
+    std::vector<std::shared_ptr<Shape>> shapes;
+    shapes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        float x = static_cast<float>(i % 100) / 50.0f;
+        if (i % 2 == 0) {
+            shapes.push_back(std::make_shared<Circle>(x));
+        } else {
+            shapes.push_back(std::make_shared<Rectangle>(x, 1.5f));
+        }
+    }
+    std::vector<closed::ShapeV> variants = closed::toVariants(shapes);
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        double result = fn();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        return std::make_pair(result, ms.count());
+    };
+
+    auto [virtualArea, virtualMs] = time([&] {
+        TotalAreaVisitor v;
+        for (const auto& shape : shapes) {
+            shape->accept(&v);
+        }
+        return v.result();
+    });
+    auto [variantArea, variantMs] = time([&] {
+        double total = 0.0;
+        for (const auto& shape : variants) {
+            total += closed::area(shape);
+        }
+        return total;
+    });
+
+    // 继承体系：vector 里的 shared_ptr + make_shared 的单块分配（控制块 + 对象，不含 malloc 头部）
+    std::size_t controlBlock = 2 * sizeof(int) + sizeof(void*);
+    std::size_t virtualBytes = sizeof(std::shared_ptr<Shape>) + controlBlock
+                             + (sizeof(Circle) + sizeof(Rectangle)) / 2;
+    std::size_t variantBytes = sizeof(closed::ShapeV);
+
+    std::cout << "shapes = " << count << "\n";
+    std::cout << "  virtual + shared_ptr: " << virtualMs << " ms, ~" << virtualBytes
+              << " bytes/shape, total area = " << virtualArea << "\n";
+    std::cout << "  std::variant by value: " << variantMs << " ms, " << variantBytes
+              << " bytes/shape, total area = " << variantArea << "\n";
+}
+
 // 测试客户端
-int main() {
+int main(int argc, char* argv[]) {
     std::vector<std::shared_ptr<Shape>> shapes;
     shapes.push_back(std::make_shared<Circle>(5.0f));
     shapes.push_back(std::make_shared<Rectangle>(4.0f, 6.0f));
@@ -90,6 +370,28 @@ int main() {
         shape->accept(&areaCalc);
     }
 
+    std::cout << "\n--- Reducing in Parallel ---" << std::endl;
+    std::cout << "Total area: " << parallelAccept(shapes, TotalAreaVisitor(), 2) << std::endl;
+    auto histogram = parallelAccept(shapes, AreaHistogramVisitor(10.0f), 2);
+    std::cout << "Area histogram (width 10):";
+    for (std::size_t n : histogram) {
+        std::cout << " " << n;
+    }
+    std::cout << std::endl;
+
+    std::cout << "\n--- Closed Hierarchy with std::variant ---" << std::endl;
+    for (const auto& shape : closed::toVariants(shapes)) {
+        std::cout << "Area: " << closed::area(shape) << std::endl;
+        closed::toShape(shape)->accept(&printer);  // 转回继承体系
+    }
+
+    std::cout << "\n--- Scaling Benchmark ---" << std::endl;
+    std::size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    benchmarkParallelAccept(count);
+
+    std::cout << "\n--- Variant vs. Virtual Benchmark ---" << std::endl;
+    benchmarkVariantVsVirtual(count);
+
     return 0;
 }
 
@@ -102,4 +404,36 @@ Rectangle with width: 4, height: 6
 --- Calculating Area ---
 Circle area: 78.5397
 Rectangle area: 24
+
+--- Reducing in Parallel ---
+Total area: 102.54
+Area histogram (width 10): 0 0 1 0 0 0 0 1
+
+--- Closed Hierarchy with std::variant ---
+Area: 78.5397
+Circle with radius: 5
+Area: 24
+Rectangle with width: 4, height: 6
+
+--- Scaling Benchmark ---
+shapes = 1000000, cores = 8
+  threads = 1, total area = 2.78198e+06, time = 6.1 ms, speedup = 1x
+  threads = 2, total area = 2.78198e+06, time = 3.2 ms, speedup = 1.9x
+  ...（耗时因机器而异）
+
+--- Variant vs. Virtual Benchmark ---
+shapes = 1000000
+  virtual + shared_ptr: 6.1 ms, ~48 bytes/shape, total area = 2.78198e+06
+  std::variant by value: 2.9 ms, 12 bytes/shape, total area = 2.78198e+06
+*/
+
+/*
+并行访问者：
+访问者本身只持有累加状态，天然适合“每线程一份 + 最后归约”的 map-reduce 方式，
+遍历过程中线程间没有共享写，也就不需要加锁。
+
+std::variant 版本：
+元素类型固定（封闭层次）时，用 std::variant 按值存储 + std::visit 分派，
+省掉了虚调用和每个元素一次的堆分配；代价是新增元素类型需要修改 ShapeV 并重新编译所有访问者。
+编译：g++ -std=c++17 -O2 -pthread Visitor.cpp -o Visitor
 */
\ No newline at end of file